@@ -11,9 +11,6 @@
 #define PIT_PORT_CONTROL 0x43                        /* Control port. */
 #define PIT_PORT_COUNTER(CHANNEL) (0x40 + (CHANNEL)) /* Counter port. */
 
-/* PIT cycles per second. */
-#define PIT_HZ 1193180
-
 /* Configure the given CHANNEL in the PIT.  In a PC, the PIT's
    three output channels are hooked up like this:
 
@@ -81,3 +78,55 @@ pit_configure_channel (int channel, int mode, int frequency)
     outb (PIT_PORT_COUNTER (channel), count >> 8);
     intr_set_level (old_level);
 }
+
+/* Starts channel 0 counting down from COUNT in mode 0
+   ("interrupt on terminal count").  The channel's output, and
+   thus interrupt line 0, rises once when the count reaches zero,
+   COUNT / PIT_HZ seconds from now, and no further interrupts
+   are generated until the channel is reconfigured.  A COUNT of
+   0 is treated as 65536. */
+void
+pit_start_oneshot (uint16_t count)
+{
+    enum intr_level old_level = intr_disable ();
+    outb (PIT_PORT_CONTROL, 0x30);
+    outb (PIT_PORT_COUNTER (0), count);
+    outb (PIT_PORT_COUNTER (0), count >> 8);
+    intr_set_level (old_level);
+}
+
+/* Returns the current value of CHANNEL's down counter. */
+uint16_t
+pit_read_counter (int channel)
+{
+    enum intr_level old_level;
+    uint16_t count;
+
+    ASSERT (channel == 0 || channel == 2);
+
+    /* Counter latch command, then read low and high bytes. */
+    old_level = intr_disable ();
+    outb (PIT_PORT_CONTROL, channel << 6);
+    count = inb (PIT_PORT_COUNTER (channel));
+    count |= inb (PIT_PORT_COUNTER (channel)) << 8;
+    intr_set_level (old_level);
+
+    return count;
+}
+
+/* Returns true if channel 0, started with pit_start_oneshot(),
+   has reached its terminal count.  Uses the read-back command to
+   latch the channel's status byte, whose top bit is the state of
+   the output pin. */
+bool
+pit_oneshot_expired (void)
+{
+    enum intr_level old_level = intr_disable ();
+    uint8_t status;
+
+    outb (PIT_PORT_CONTROL, 0xe2);
+    status = inb (PIT_PORT_COUNTER (0));
+    intr_set_level (old_level);
+
+    return (status & 0x80) != 0;
+}
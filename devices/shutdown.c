@@ -5,6 +5,9 @@
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "threads/io.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
@@ -124,6 +127,11 @@ print_stats (void)
 {
     timer_print_stats ();
     thread_print_stats ();
+    palloc_print_stats ();
+    malloc_print_stats ();
+#ifdef LOCK_PROFILE
+    lock_profile_print ();
+#endif
 #ifdef FILESYS
     block_print_stats ();
 #endif
@@ -1,9 +1,11 @@
 #include "devices/timer.h"
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
@@ -24,17 +26,68 @@ static int64_t ticks;
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Longest and total time spent in timer_interrupt(), in TSC
+   cycles, and the number of interrupts they cover.  Reset by
+   timer_reset_interrupt_stats(). */
+static uint64_t interrupt_max_cycles;
+static uint64_t interrupt_total_cycles;
+static int64_t interrupt_cnt;
+
+/* If true, the idle thread stops the periodic tick while no
+   thread is runnable.  Controlled by kernel command-line option
+   "-tickless". */
+bool timer_tickless;
+
+/* PIT cycles per timer tick. */
+#define PIT_TICK_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Shortest one-shot, in PIT cycles. */
+#define ONESHOT_MIN 2
+
+/* Fine-grained time is kept in PIT cycles since boot, with tick
+   N starting at N * PIT_TICK_COUNT.
+
+   Channel 0 normally runs in periodic mode, interrupting at
+   every tick boundary.  While ONESHOT is true, it was instead
+   started with pit_start_oneshot() at time ONESHOT_START and
+   interrupts once, ONESHOT_COUNT cycles later.  A one-shot ends
+   either in the middle of a tick, to wake a sub-tick sleeper, or
+   at a tick boundary, possibly several ticks away when tickless
+   idle skips ticks. */
+static bool oneshot;
+static int64_t oneshot_start;
+static uint16_t oneshot_count;
+
+/* Last value returned by timer_cycles(), which never goes
+   backward. */
+static int64_t last_cycles;
+
+/* Threads sleeping for less than a tick, in order of deadline. */
+static struct list hr_sleepers;
+
+/* A thread in hr_sleep(). */
+struct hr_sleeper
+  {
+    struct list_elem elem;      /* List element. */
+    int64_t deadline;           /* Wakeup time, in PIT cycles. */
+    struct thread *thread;      /* Sleeping thread. */
+  };
+
 static intr_handler_func timer_interrupt;
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
 static void real_time_delay (int64_t num, int32_t denom);
+static int64_t timer_cycles (void);
+static void hr_sleep (int64_t cycles);
+static void hr_wakeup (int64_t now);
 
 /* Sets up the timer to interrupt TIMER_FREQ times per second,
    and registers the corresponding interrupt. */
 void
 timer_init (void)
 {
+    list_init (&hr_sleepers);
     pit_configure_channel (0, 2, TIMER_FREQ);
     intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
@@ -84,6 +137,20 @@ timer_elapsed (int64_t then)
     return timer_ticks () - then;
 }
 
+/* Returns the time since the OS booted, in nanoseconds.  Unlike
+   timer_ticks(), this has the resolution of the PIT's input
+   clock, about 838 ns. */
+int64_t
+timer_ns (void)
+{
+    enum intr_level old_level = intr_disable ();
+    int64_t cycles = timer_cycles ();
+    intr_set_level (old_level);
+
+    return (cycles / PIT_HZ * 1000000000
+            + cycles % PIT_HZ * 1000000000 / PIT_HZ);
+}
+
 /* Sleeps for approximately TICKS timer ticks.  Interrupts must
    be turned on. */
 void
@@ -160,6 +227,142 @@ timer_ndelay (int64_t ns)
     real_time_delay (ns, 1000 * 1000 * 1000);
 }
 
+/* Returns the longest time, in TSC cycles, that the timer
+   interrupt handler has taken since boot or since the last call
+   to timer_reset_interrupt_stats(). */
+uint64_t
+timer_interrupt_max_cycles (void)
+{
+    enum intr_level old_level = intr_disable ();
+    uint64_t max = interrupt_max_cycles;
+    intr_set_level (old_level);
+    return max;
+}
+
+/* Returns the average time, in TSC cycles, that the timer
+   interrupt handler has taken since boot or since the last call
+   to timer_reset_interrupt_stats(). */
+uint64_t
+timer_interrupt_avg_cycles (void)
+{
+    enum intr_level old_level = intr_disable ();
+    uint64_t avg = interrupt_cnt > 0 ? interrupt_total_cycles / interrupt_cnt : 0;
+    intr_set_level (old_level);
+    return avg;
+}
+
+/* Returns the number of timer interrupts since boot or since
+   the last call to timer_reset_interrupt_stats().  Without
+   tickless idle this equals the number of ticks. */
+int64_t
+timer_interrupt_count (void)
+{
+    enum intr_level old_level = intr_disable ();
+    int64_t cnt = interrupt_cnt;
+    intr_set_level (old_level);
+    return cnt;
+}
+
+/* Resets the timer interrupt handler statistics. */
+void
+timer_reset_interrupt_stats (void)
+{
+    enum intr_level old_level = intr_disable ();
+    interrupt_max_cycles = 0;
+    interrupt_total_cycles = 0;
+    interrupt_cnt = 0;
+    intr_set_level (old_level);
+}
+
+/* Returns the time at which channel 0 will next interrupt, in
+   PIT cycles. */
+static int64_t
+next_event (void)
+{
+    return oneshot ? oneshot_start + oneshot_count
+                   : (ticks + 1) * PIT_TICK_COUNT;
+}
+
+/* Returns the deadline of the first sub-tick sleeper, or
+   INT64_MAX if there is none. */
+static int64_t
+hr_first_deadline (void)
+{
+    if (list_empty (&hr_sleepers))
+        return INT64_MAX;
+    return list_entry (list_front (&hr_sleepers),
+                       struct hr_sleeper, elem)->deadline;
+}
+
+/* Starts a one-shot that interrupts at time END, given that it
+   is now NOW.  If END does not fit in the PIT's 16-bit counter,
+   stops at the last tick boundary that does. */
+static void
+program_oneshot (int64_t now, int64_t end)
+{
+    if (end - now > UINT16_MAX)
+        end = (now + UINT16_MAX) / PIT_TICK_COUNT * PIT_TICK_COUNT;
+    if (end - now < ONESHOT_MIN)
+        end = now + ONESHOT_MIN;
+
+    oneshot = true;
+    oneshot_start = now;
+    oneshot_count = end - now;
+    pit_start_oneshot (oneshot_count);
+}
+
+/* Called by the idle thread, with interrupts off, just before it
+   halts the CPU.  In tickless mode, if no thread needs to wake
+   up at the next tick, replaces the periodic tick by a single
+   interrupt at the next wakeup.  The PIT's 16-bit counter limits
+   this to a few ticks at a time at TIMER_FREQ == 100, so long
+   idle periods take one interrupt every few ticks instead of one
+   per tick. */
+void
+timer_idle_enter (void)
+{
+    int64_t now, end, wakeup;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    if (!timer_tickless)
+        return;
+
+    wakeup = get_next_tick_to_wakeup ();
+    end = wakeup < INT64_MAX / PIT_TICK_COUNT ? wakeup * PIT_TICK_COUNT
+                                              : INT64_MAX;
+    if (hr_first_deadline () < end)
+        end = hr_first_deadline ();
+    if (end <= next_event ())
+        return;
+
+    now = timer_cycles ();
+    program_oneshot (now, end);
+}
+
+/* Called by the scheduler, with interrupts off, when the idle
+   thread gives up the CPU.  If a tickless one-shot is pending
+   past the next tick boundary, cuts it short to end at that
+   boundary so the new thread gets its regular tick back.  The
+   ticks that passed while idle are accounted when the one-shot
+   fires, at most one tick from now. */
+void
+timer_idle_exit (void)
+{
+    int64_t now, boundary;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    /* If the one-shot already expired, its interrupt is pending. */
+    if (!oneshot || pit_oneshot_expired ())
+        return;
+
+    now = timer_cycles ();
+    boundary = (now / PIT_TICK_COUNT + 1) * PIT_TICK_COUNT;
+    if (boundary < next_event ())
+        program_oneshot (now, boundary);
+}
+
 /* Prints timer statistics. */
 void
 timer_print_stats (void)
@@ -171,13 +374,151 @@ timer_print_stats (void)
 static void
 timer_interrupt (struct intr_frame *args UNUSED)
 {
-    ticks++;
-    thread_tick ();
+    uint64_t start = rdtsc ();
+    uint64_t elapsed;
+    bool was_oneshot = oneshot;
+    int64_t now, new_ticks, boundary;
 
-    
-    if (get_next_tick_to_wakeup() <= ticks) {
-      thread_wakeup(ticks); 
-    }
+    if (oneshot)
+        {
+            now = oneshot_start + oneshot_count;
+            new_ticks = now / PIT_TICK_COUNT;
+            oneshot = false;
+        }
+    else
+        {
+            new_ticks = ticks + 1;
+            now = new_ticks * PIT_TICK_COUNT;
+        }
+    if (now > last_cycles)
+        last_cycles = now;
+
+    /* A one-shot may end between ticks, or, after tickless idle,
+       several ticks later.  Ticks skipped while idle are charged
+       to the idle thread. */
+    if (new_ticks > ticks)
+        {
+            while (ticks + 1 < new_ticks)
+                {
+                    ticks++;
+                    thread_tick_idle ();
+                }
+            ticks++;
+            thread_tick ();
+
+            if (get_next_tick_to_wakeup () <= ticks)
+                thread_wakeup (ticks);
+        }
+
+    hr_wakeup (now);
+
+    /* Interrupt again at the next sub-tick deadline or tick
+       boundary, whichever comes first. */
+    boundary = (now / PIT_TICK_COUNT + 1) * PIT_TICK_COUNT;
+    if (hr_first_deadline () < boundary)
+        program_oneshot (now, hr_first_deadline ());
+    else if (now % PIT_TICK_COUNT != 0)
+        program_oneshot (now, boundary);
+    else if (was_oneshot)
+        pit_configure_channel (0, 2, TIMER_FREQ);
+
+    elapsed = rdtsc () - start;
+    if (elapsed > interrupt_max_cycles)
+        interrupt_max_cycles = elapsed;
+    interrupt_total_cycles += elapsed;
+    interrupt_cnt++;
+}
+
+/* Returns the current time in PIT cycles since boot.  Must be
+   called with interrupts off. */
+static int64_t
+timer_cycles (void)
+{
+    int64_t now;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    if (!oneshot)
+        {
+            unsigned count = pit_read_counter (0);
+
+            now = ticks * PIT_TICK_COUNT;
+            if (count >= 1 && count <= PIT_TICK_COUNT)
+                now += PIT_TICK_COUNT - count;
+        }
+    else if (pit_oneshot_expired ())
+        now = oneshot_start + oneshot_count;
+    else
+        {
+            unsigned count = pit_read_counter (0);
+
+            now = oneshot_start;
+            if (count <= oneshot_count)
+                now += oneshot_count - count;
+        }
+
+    /* The counter may already have started the next tick while
+       the interrupt that advances TICKS is still pending, which
+       would make time appear to jump backward. */
+    if (now < last_cycles)
+        now = last_cycles;
+    last_cycles = now;
+    return now;
+}
+
+/* Returns true if sleeper A has an earlier deadline than B. */
+static bool
+hr_deadline_less (const struct list_elem *a_, const struct list_elem *b_,
+                  void *aux UNUSED)
+{
+    const struct hr_sleeper *a = list_entry (a_, struct hr_sleeper, elem);
+    const struct hr_sleeper *b = list_entry (b_, struct hr_sleeper, elem);
+
+    return a->deadline < b->deadline;
+}
+
+/* Blocks the running thread for CYCLES PIT cycles.  If the
+   deadline comes before the next timer interrupt, reprograms the
+   PIT to interrupt at the deadline. */
+static void
+hr_sleep (int64_t cycles)
+{
+    struct hr_sleeper sleeper;
+    enum intr_level old_level;
+    int64_t now;
+
+    ASSERT (!intr_context ());
+    ASSERT (intr_get_level () == INTR_ON);
+
+    old_level = intr_disable ();
+    now = timer_cycles ();
+    sleeper.deadline = now + cycles;
+    sleeper.thread = thread_current ();
+    list_insert_ordered (&hr_sleepers, &sleeper.elem, hr_deadline_less, NULL);
+    if (sleeper.deadline < next_event ())
+        program_oneshot (now, sleeper.deadline);
+
+    thread_block ();
+    intr_set_level (old_level);
+}
+
+/* Wakes up the sub-tick sleepers whose deadline is at most
+   ONESHOT_MIN cycles after NOW.  Called from the timer
+   interrupt. */
+static void
+hr_wakeup (int64_t now)
+{
+    bool woke = false;
+
+    while (hr_first_deadline () <= now + ONESHOT_MIN)
+        {
+            struct hr_sleeper *s = list_entry (list_pop_front (&hr_sleepers),
+                                               struct hr_sleeper, elem);
+            thread_unblock (s->thread);
+            woke = true;
+        }
+    if (woke)
+        thread_yield_if_preempted ();
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -235,9 +576,11 @@ real_time_sleep (int64_t num, int32_t denom)
         }
     else
         {
-            /* Otherwise, use a busy-wait loop for more accurate
-         sub-tick timing. */
-            real_time_delay (num, denom);
+            /* Otherwise, block until a one-shot timer interrupt at
+         the exact deadline, rounded up to a PIT cycle. */
+            int64_t cycles = (num * PIT_HZ + denom - 1) / denom;
+            if (cycles > 0)
+                hr_sleep (cycles);
         }
 }
 
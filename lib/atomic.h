@@ -0,0 +1,30 @@
+#ifndef __LIB_ATOMIC_H
+#define __LIB_ATOMIC_H
+
+/* Atomic read-modify-write operations on 32-bit integers, shared
+   by the kernel and user programs.  Each is a single locked
+   instruction and acts as a full compiler and memory barrier.
+   See [IA32-v2a] "CMPXCHG" and [IA32-v2b] "XCHG". */
+
+/* If *P equals OLD, stores NEW into *P.  Either way, returns the
+   value that *P held before the operation. */
+static inline int
+atomic_cmpxchg (volatile int *p, int old, int new)
+{
+    int prev;
+    asm volatile ("lock cmpxchgl %2, %1"
+                  : "=a"(prev), "+m"(*p)
+                  : "r"(new), "0"(old)
+                  : "memory", "cc");
+    return prev;
+}
+
+/* Stores NEW into *P and returns the previous value of *P. */
+static inline int
+atomic_xchg (volatile int *p, int new)
+{
+    asm volatile ("xchgl %0, %1" : "+r"(new), "+m"(*p) : : "memory");
+    return new;
+}
+
+#endif /* lib/atomic.h */
@@ -3,6 +3,7 @@
 #include <limits.h>
 #include <round.h>
 #include <stdio.h>
+#include "threads/cpu.h"
 #include "threads/malloc.h"
 #ifdef FILESYS
 #include "filesys/file.h"
@@ -69,6 +70,74 @@ last_mask (const struct bitmap *b)
     return last_bits ? ((elem_type)1 << last_bits) - 1 : (elem_type)-1;
 }
 
+/* Word-at-a-time helpers.
+
+   The multiple-bit operations below work on whole elements: a
+   range of bits covers a partial first element, zero or more full
+   elements, and a partial last element, and each element is
+   handled with one mask instead of one bitmap_test() per bit.
+   Searches skip elements that hold no bit of the wanted value and
+   use a bit-scan instruction to find the first one that does. */
+
+/* Returns a mask of the bits at or above bit BIT_IDX % ELEM_BITS
+   in BIT_IDX's element. */
+static inline elem_type
+from_mask (size_t bit_idx)
+{
+    return ~(bit_mask (bit_idx) - 1);
+}
+
+/* Returns a mask of the bits below bit BIT_IDX % ELEM_BITS in
+   BIT_IDX's element, or all bits if BIT_IDX is the first bit of
+   an element. */
+static inline elem_type
+below_mask (size_t bit_idx)
+{
+    return bit_idx % ELEM_BITS ? bit_mask (bit_idx) - 1 : (elem_type)-1;
+}
+
+/* Returns element E with the bits equal to VALUE set to 1 and the
+   others set to 0. */
+static inline elem_type
+elem_match (elem_type e, bool value)
+{
+    return value ? e : ~e;
+}
+
+/* Returns the number of 1-bits in E. */
+static inline int
+elem_popcount (elem_type e)
+{
+    e = e - ((e >> 1) & 0x55555555);
+    e = (e & 0x33333333) + ((e >> 2) & 0x33333333);
+    e = (e + (e >> 4)) & 0x0f0f0f0f;
+    return (e * 0x01010101) >> 24;
+}
+
+/* Returns the index of the first bit in B at or after START that
+   is set to VALUE, or B's size if there is none. */
+static size_t
+next_bit (const struct bitmap *b, size_t start, bool value)
+{
+    size_t idx = elem_idx (start);
+    size_t last = elem_cnt (b->bit_cnt);
+    elem_type e;
+    size_t bit;
+
+    if (start >= b->bit_cnt)
+        return b->bit_cnt;
+
+    e = elem_match (b->bits[idx], value) & from_mask (start);
+    while (e == 0)
+        {
+            if (++idx >= last)
+                return b->bit_cnt;
+            e = elem_match (b->bits[idx], value);
+        }
+    bit = idx * ELEM_BITS + bit_scan_forward (e);
+    return bit < b->bit_cnt ? bit : b->bit_cnt;
+}
+
 /* Creation and destruction. */
 
 /* Initializes B to be a bitmap of BIT_CNT bits
@@ -214,18 +283,35 @@ bitmap_set_all (struct bitmap *b, bool value)
     bitmap_set_multiple (b, 0, bitmap_size (b), value);
 }
 
-/* Sets the CNT bits starting at START in B to VALUE. */
+/* Sets the CNT bits starting at START in B to VALUE.
+   Each element is updated atomically, as by bitmap_set(). */
 void
 bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
 {
-    size_t i;
+    size_t idx, last;
 
     ASSERT (b != NULL);
     ASSERT (start <= b->bit_cnt);
     ASSERT (start + cnt <= b->bit_cnt);
 
-    for (i = 0; i < cnt; i++)
-        bitmap_set (b, start + i, value);
+    if (cnt == 0)
+        return;
+
+    idx = elem_idx (start);
+    last = elem_idx (start + cnt - 1);
+    for (; idx <= last; idx++)
+        {
+            elem_type mask = (elem_type)-1;
+            if (idx == elem_idx (start))
+                mask &= from_mask (start);
+            if (idx == last)
+                mask &= below_mask (start + cnt);
+
+            if (value)
+                asm ("orl %1, %0" : "+m"(b->bits[idx]) : "r"(mask) : "cc");
+            else
+                asm ("andl %1, %0" : "+m"(b->bits[idx]) : "r"(~mask) : "cc");
+        }
 }
 
 /* Returns the number of bits in B between START and START + CNT,
@@ -233,16 +319,27 @@ bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
 size_t
 bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
 {
-    size_t i, value_cnt;
+    size_t idx, last, value_cnt;
 
     ASSERT (b != NULL);
     ASSERT (start <= b->bit_cnt);
     ASSERT (start + cnt <= b->bit_cnt);
 
+    if (cnt == 0)
+        return 0;
+
     value_cnt = 0;
-    for (i = 0; i < cnt; i++)
-        if (bitmap_test (b, start + i) == value)
-            value_cnt++;
+    idx = elem_idx (start);
+    last = elem_idx (start + cnt - 1);
+    for (; idx <= last; idx++)
+        {
+            elem_type e = elem_match (b->bits[idx], value);
+            if (idx == elem_idx (start))
+                e &= from_mask (start);
+            if (idx == last)
+                e &= below_mask (start + cnt);
+            value_cnt += elem_popcount (e);
+        }
     return value_cnt;
 }
 
@@ -251,16 +348,11 @@ bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
 bool
 bitmap_contains (const struct bitmap *b, size_t start, size_t cnt, bool value)
 {
-    size_t i;
-
     ASSERT (b != NULL);
     ASSERT (start <= b->bit_cnt);
     ASSERT (start + cnt <= b->bit_cnt);
 
-    for (i = 0; i < cnt; i++)
-        if (bitmap_test (b, start + i) == value)
-            return true;
-    return false;
+    return cnt > 0 && next_bit (b, start, value) < start + cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
@@ -292,7 +384,11 @@ bitmap_all (const struct bitmap *b, size_t start, size_t cnt)
 /* Finds and returns the starting index of the first group of CNT
    consecutive bits in B at or after START that are all set to
    VALUE.
-   If there is no such group, returns BITMAP_ERROR. */
+   If there is no such group, returns BITMAP_ERROR.
+
+   Walks the runs of VALUE bits in order, jumping from the start
+   of each run to its end and from there to the start of the next,
+   so each element is examined about once whatever CNT is. */
 size_t
 bitmap_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
 {
@@ -302,10 +398,22 @@ bitmap_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
     if (cnt <= b->bit_cnt)
         {
             size_t last = b->bit_cnt - cnt;
-            size_t i;
-            for (i = start; i <= last; i++)
-                if (!bitmap_contains (b, i, cnt, !value))
-                    return i;
+            size_t i = start;
+
+            if (cnt == 0)
+                return i <= last ? i : BITMAP_ERROR;
+            while (i <= last)
+                {
+                    size_t end;
+
+                    i = next_bit (b, i, value);
+                    if (i > last)
+                        break;
+                    end = next_bit (b, i, !value);
+                    if (end - i >= cnt)
+                        return i;
+                    i = end;
+                }
         }
     return BITMAP_ERROR;
 }
@@ -0,0 +1,168 @@
+/* Single-producer, single-consumer ring buffer.
+
+   See ring.h for basic information.
+
+   HEAD and TAIL count elements ever enqueued and dequeued, and
+   are reduced modulo the capacity only to index the buffer.
+   Because the capacity is a power of two, HEAD - TAIL is the
+   number of elements in the ring even after the counters wrap.
+
+   On x86 the processor neither reorders stores with other stores
+   nor loads with other loads, so keeping the compiler from
+   moving buffer accesses across the index updates is enough to
+   order them for an interrupt handler or another CPU. */
+
+#include "ring.h"
+#include <string.h>
+#include "../debug.h"
+
+/* Keeps the compiler from moving memory accesses across it. */
+#define ring_barrier() asm volatile ("" : : : "memory")
+
+static void copy_in (struct ring *, size_t pos, const uint8_t *, size_t cnt);
+static void copy_out (const struct ring *, size_t pos, uint8_t *, size_t cnt);
+
+/* Initializes R as an empty ring of CAPACITY elements of
+   ELEM_SIZE bytes each, stored in BUF, which must be at least
+   RING_BUF_SIZE (CAPACITY, ELEM_SIZE) bytes long.  CAPACITY must
+   be a power of two. */
+void
+ring_init (struct ring *r, void *buf, size_t capacity, size_t elem_size)
+{
+    ASSERT (r != NULL);
+    ASSERT (buf != NULL);
+    ASSERT (capacity > 0 && (capacity & (capacity - 1)) == 0);
+    ASSERT (elem_size > 0);
+
+    r->buf = buf;
+    r->elem_size = elem_size;
+    r->mask = capacity - 1;
+    r->head = r->tail = 0;
+}
+
+/* Returns the number of elements R can hold. */
+size_t
+ring_capacity (const struct ring *r)
+{
+    return r->mask + 1;
+}
+
+/* Returns the number of elements in R.  Exact when called by the
+   producer or the consumer; otherwise it may be out of date as
+   soon as it returns. */
+size_t
+ring_count (const struct ring *r)
+{
+    return r->head - r->tail;
+}
+
+/* Returns the number of elements that could be added to R. */
+size_t
+ring_space (const struct ring *r)
+{
+    return ring_capacity (r) - ring_count (r);
+}
+
+/* Returns true if R holds no elements. */
+bool
+ring_empty (const struct ring *r)
+{
+    return r->head == r->tail;
+}
+
+/* Returns true if R has no room for another element. */
+bool
+ring_full (const struct ring *r)
+{
+    return ring_count (r) == ring_capacity (r);
+}
+
+/* Adds up to CNT elements from ELEMS to the end of R, as many as
+   fit, and returns the number added.  Only the producer may call
+   this function. */
+size_t
+ring_enqueue (struct ring *r, const void *elems, size_t cnt)
+{
+    size_t head = r->head;
+    size_t space = ring_capacity (r) - (head - r->tail);
+
+    if (cnt > space)
+        cnt = space;
+    if (cnt == 0)
+        return 0;
+
+    /* Read TAIL before overwriting the slots it freed. */
+    ring_barrier ();
+    copy_in (r, head, elems, cnt);
+
+    /* Publish the elements only once they are in place. */
+    ring_barrier ();
+    r->head = head + cnt;
+    return cnt;
+}
+
+/* Removes up to CNT elements from the front of R into ELEMS, as
+   many as there are, and returns the number removed.  Only the
+   consumer may call this function. */
+size_t
+ring_dequeue (struct ring *r, void *elems, size_t cnt)
+{
+    size_t tail = r->tail;
+
+    cnt = ring_peek (r, elems, cnt);
+    if (cnt == 0)
+        return 0;
+
+    /* Free the slots only once they have been copied out. */
+    ring_barrier ();
+    r->tail = tail + cnt;
+    return cnt;
+}
+
+/* Copies up to CNT elements from the front of R into ELEMS
+   without removing them, and returns the number copied.  Only
+   the consumer may call this function. */
+size_t
+ring_peek (const struct ring *r, void *elems, size_t cnt)
+{
+    size_t tail = r->tail;
+    size_t avail = r->head - tail;
+
+    if (cnt > avail)
+        cnt = avail;
+    if (cnt == 0)
+        return 0;
+
+    /* Read HEAD before reading the slots it covers. */
+    ring_barrier ();
+    copy_out (r, tail, elems, cnt);
+    return cnt;
+}
+
+/* Copies CNT elements from SRC into R's buffer starting at
+   element POS, wrapping around the end of the buffer. */
+static void
+copy_in (struct ring *r, size_t pos, const uint8_t *src, size_t cnt)
+{
+    size_t idx = pos & r->mask;
+    size_t first = ring_capacity (r) - idx;
+
+    if (first > cnt)
+        first = cnt;
+    memcpy (r->buf + idx * r->elem_size, src, first * r->elem_size);
+    memcpy (r->buf, src + first * r->elem_size, (cnt - first) * r->elem_size);
+}
+
+/* Copies CNT elements from R's buffer starting at element POS
+   into DST, wrapping around the end of the buffer. */
+static void
+copy_out (const struct ring *r, size_t pos, uint8_t *dst, size_t cnt)
+{
+    size_t idx = pos & r->mask;
+    size_t first = ring_capacity (r) - idx;
+
+    if (first > cnt)
+        first = cnt;
+    memcpy (dst, r->buf + idx * r->elem_size, first * r->elem_size);
+    memcpy (dst + first * r->elem_size, r->buf, (cnt - first) * r->elem_size);
+}
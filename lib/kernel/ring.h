@@ -0,0 +1,48 @@
+#ifndef __LIB_KERNEL_RING_H
+#define __LIB_KERNEL_RING_H
+
+/* Single-producer, single-consumer ring buffer.
+
+   A ring holds up to a power-of-two number of fixed-size
+   elements in a caller-supplied buffer.  Exactly one producer may
+   call ring_enqueue() and exactly one consumer may call
+   ring_dequeue() at the same time without any lock and without
+   turning interrupts off, so a ring can carry data from an
+   interrupt handler to a thread or the other way around.  Each
+   side writes only its own index, and publishes it only after
+   the elements it covers have been copied, so the other side
+   never sees a slot that is half written or half read.
+
+   The ring never blocks.  A consumer that wants to sleep until
+   data arrives must arrange its own wakeup, for example with a
+   semaphore that the producer ups after enqueuing. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A single-producer, single-consumer ring. */
+struct ring
+{
+    uint8_t *buf;           /* Storage for CAPACITY elements. */
+    size_t elem_size;       /* Size of each element, in bytes. */
+    size_t mask;            /* CAPACITY - 1. */
+    volatile size_t head;   /* Elements ever enqueued; producer only. */
+    volatile size_t tail;   /* Elements ever dequeued; consumer only. */
+};
+
+/* Bytes of buffer needed for CAPACITY elements of SIZE bytes. */
+#define RING_BUF_SIZE(CAPACITY, SIZE) ((CAPACITY) * (SIZE))
+
+void ring_init (struct ring *, void *buf, size_t capacity, size_t elem_size);
+size_t ring_capacity (const struct ring *);
+size_t ring_count (const struct ring *);
+size_t ring_space (const struct ring *);
+bool ring_empty (const struct ring *);
+bool ring_full (const struct ring *);
+
+size_t ring_enqueue (struct ring *, const void *elems, size_t cnt);
+size_t ring_dequeue (struct ring *, void *elems, size_t cnt);
+size_t ring_peek (const struct ring *, void *elems, size_t cnt);
+
+#endif /* lib/kernel/ring.h */
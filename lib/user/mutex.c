@@ -0,0 +1,53 @@
+#include <mutex.h>
+#include <atomic.h>
+#include <syscall.h>
+
+/* This is the three-state mutex from Ulrich Drepper, "Futexes
+   Are Tricky".  A holder that finds the state MUTEX_HELD on
+   release knows nobody is asleep and skips the system call.  A
+   thread that must sleep first marks the state MUTEX_CONTENDED,
+   and keeps it that way once it acquires the mutex, because it
+   cannot tell whether other sleepers remain. */
+
+/* Initializes MUTEX as unheld. */
+void
+mutex_init (struct mutex *mutex)
+{
+    mutex->state = MUTEX_FREE;
+}
+
+/* Acquires MUTEX, sleeping until it becomes available if
+   necessary. */
+void
+mutex_lock (struct mutex *mutex)
+{
+    int state = atomic_cmpxchg (&mutex->state, MUTEX_FREE, MUTEX_HELD);
+
+    if (state == MUTEX_FREE)
+        return;
+
+    if (state != MUTEX_CONTENDED)
+        state = atomic_xchg (&mutex->state, MUTEX_CONTENDED);
+    while (state != MUTEX_FREE)
+        {
+            futex_wait ((int *) &mutex->state, MUTEX_CONTENDED);
+            state = atomic_xchg (&mutex->state, MUTEX_CONTENDED);
+        }
+}
+
+/* Tries to acquire MUTEX without sleeping.  Returns true if
+   successful, false if MUTEX was already held. */
+bool
+mutex_trylock (struct mutex *mutex)
+{
+    return atomic_cmpxchg (&mutex->state, MUTEX_FREE, MUTEX_HELD) == MUTEX_FREE;
+}
+
+/* Releases MUTEX, which the caller must hold, and wakes one
+   waiter if there may be any. */
+void
+mutex_unlock (struct mutex *mutex)
+{
+    if (atomic_xchg (&mutex->state, MUTEX_FREE) == MUTEX_CONTENDED)
+        futex_wake ((int *) &mutex->state, 1);
+}
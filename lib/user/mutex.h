@@ -0,0 +1,30 @@
+#ifndef __LIB_USER_MUTEX_H
+#define __LIB_USER_MUTEX_H
+
+#include <stdbool.h>
+
+/* A mutual exclusion lock that lives entirely in user memory.
+   Acquiring a free mutex or releasing one that nobody waits for
+   is a single atomic instruction; the futex system calls are
+   made only when threads actually contend for it.
+
+   The mutex is not recursive and does not track its owner. */
+struct mutex
+{
+    volatile int state;         /* MUTEX_* state below. */
+};
+
+/* Mutex states. */
+#define MUTEX_FREE 0            /* Not held. */
+#define MUTEX_HELD 1            /* Held, no waiters. */
+#define MUTEX_CONTENDED 2       /* Held, possibly with waiters. */
+
+/* Initializer for a statically allocated mutex. */
+#define MUTEX_INITIALIZER { MUTEX_FREE }
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+#endif /* lib/user/mutex.h */
@@ -178,3 +178,15 @@ inumber (int fd)
 {
     return syscall1 (SYS_INUMBER, fd);
 }
+
+int
+futex_wait (int *addr, int val)
+{
+    return syscall2 (SYS_FUTEX_WAIT, addr, val);
+}
+
+int
+futex_wake (int *addr, int cnt)
+{
+    return syscall2 (SYS_FUTEX_WAKE, addr, cnt);
+}
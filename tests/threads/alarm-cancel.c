@@ -0,0 +1,65 @@
+/* Checks that a timed wait woken long before its deadline leaves
+   nothing behind in the sleep wheel.  A waiter blocks in
+   sema_down_timeout() with a timeout far enough away to land in
+   an upper level of the wheel, and the main thread ups the
+   semaphore right away.  From then on no thread is sleeping, so
+   the next wakeup tick must stay unset, both immediately and
+   after the tick at which the waiter's slot would have been
+   cascaded.  Otherwise tickless idle would arm a one-shot for
+   that slot on every revolution of the wheel. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define FAR_TIMEOUT 200
+
+static struct semaphore sema;
+static bool woken;
+
+static void
+waiter (void *aux UNUSED)
+{
+    woken = sema_down_timeout (&sema, FAR_TIMEOUT);
+}
+
+static bool
+wakeup_pending (void)
+{
+    enum intr_level old_level = intr_disable ();
+    bool pending = get_next_tick_to_wakeup () != INT64_MAX;
+    intr_set_level (old_level);
+    return pending;
+}
+
+void
+test_alarm_cancel (void)
+{
+    ASSERT (!wakeup_pending ());
+
+    /* The waiter runs at a higher priority, so it blocks in
+       sema_down_timeout() before thread_create() returns, and
+       runs to completion as soon as we up the semaphore. */
+    sema_init (&sema, 0);
+    thread_create ("waiter", PRI_DEFAULT + 1, waiter, NULL);
+    if (!wakeup_pending ())
+        fail ("no wakeup pending for the timed wait");
+    msg ("waiter blocked");
+
+    sema_up (&sema);
+    if (!woken)
+        fail ("sema_down_timeout() timed out despite sema_up()");
+    if (wakeup_pending ())
+        fail ("wakeup still pending after the timed wait was woken");
+    msg ("no wakeup pending after sema_up");
+
+    timer_sleep (FAR_TIMEOUT + 100);
+    if (wakeup_pending ())
+        fail ("wakeup pending after passing the cancelled deadline");
+    msg ("no wakeup pending after the cancelled deadline");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-cancel) begin
+(alarm-cancel) waiter blocked
+(alarm-cancel) no wakeup pending after sema_up
+(alarm-cancel) no wakeup pending after the cancelled deadline
+(alarm-cancel) end
+EOF
+pass;
@@ -0,0 +1,92 @@
+/* Compares sleeping for less than one timer tick with
+   timer_usleep(), which blocks until a one-shot PIT interrupt,
+   against busy-waiting with timer_udelay().  For each duration it
+   reports how far past the requested time each call returned,
+   measured with timer_ns(), and how many loops a low-priority
+   spinner thread managed to run in the meantime.  A busy-wait
+   leaves no CPU for the spinner; a sleep should leave most of
+   it. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define ITERATIONS 20
+
+static thread_func spinner;
+static struct semaphore done_sema;
+static volatile bool stop;
+static volatile int64_t spin_loops;
+
+static const int durations_us[] = { 20, 100, 500, 2000 };
+
+/* Runs DELAY for US microseconds ITERATIONS times.  Stores the
+   average and maximum overshoot in microseconds into *AVG and
+   *MAX and returns the number of spinner loops run meanwhile. */
+static int64_t
+measure (void (*delay) (int64_t), int us, int64_t *avg, int64_t *max)
+{
+    int64_t total = 0;
+    int64_t loops = spin_loops;
+    int i;
+
+    *max = 0;
+    for (i = 0; i < ITERATIONS; i++)
+        {
+            int64_t start = timer_ns ();
+            int64_t over;
+
+            delay (us);
+            over = (timer_ns () - start) / 1000 - us;
+            if (over < 0)
+                over = 0;
+            total += over;
+            if (over > *max)
+                *max = over;
+        }
+    *avg = total / ITERATIONS;
+    return spin_loops - loops;
+}
+
+void
+test_alarm_hires_bench (void)
+{
+    size_t i;
+
+    sema_init (&done_sema, 0);
+    stop = false;
+    thread_create ("spinner", PRI_MIN, spinner, NULL);
+
+    for (i = 0; i < sizeof durations_us / sizeof *durations_us; i++)
+        {
+            int us = durations_us[i];
+            int64_t busy_avg, busy_max, sleep_avg, sleep_max;
+            int64_t busy_loops, sleep_loops;
+
+            busy_loops = measure (timer_udelay, us, &busy_avg, &busy_max);
+            sleep_loops = measure (timer_usleep, us, &sleep_avg, &sleep_max);
+
+            msg ("%d us: busy-wait +%" PRId64 "/%" PRId64 " us, "
+                 "%" PRId64 " spinner loops; "
+                 "sleep +%" PRId64 "/%" PRId64 " us, "
+                 "%" PRId64 " spinner loops",
+                 us, busy_avg, busy_max, busy_loops,
+                 sleep_avg, sleep_max, sleep_loops);
+        }
+
+    stop = true;
+    sema_down (&done_sema);
+    pass ();
+}
+
+static void
+spinner (void *aux UNUSED)
+{
+    while (!stop)
+        spin_loops++;
+    sema_up (&done_sema);
+}
@@ -0,0 +1,29 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that every duration
+# reported a result and the test passed.  Each result gives the
+# average and maximum overshoot, in microseconds, and the number
+# of loops a low-priority thread ran meanwhile:
+#
+# (alarm-hires-bench) 20 us: busy-wait +3/9 us, 0 spinner loops; sleep +14/30 us, 5210 spinner loops
+# (alarm-hires-bench) 100 us: busy-wait +5/12 us, 0 spinner loops; sleep +15/31 us, 40300 spinner loops
+# (alarm-hires-bench) 500 us: busy-wait +12/25 us, 0 spinner loops; sleep +16/29 us, 231000 spinner loops
+# (alarm-hires-bench) 2000 us: busy-wait +41/70 us, 0 spinner loops; sleep +15/33 us, 940000 spinner loops
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/\d+ us: busy-wait \+\d+\/\d+ us, \d+ spinner loops; sleep \+\d+\/\d+ us, \d+ spinner loops/,
+		      @output);
+fail "Expected 4 results but found " . scalar (@results) . ".\n"
+  if @results != 4;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(alarm-hires-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,65 @@
+/* Checks tickless idle.  Two threads sleep for different
+   lengths of time while the CPU has nothing else to do.  Both
+   must wake up on time, in order, and the timer must have
+   interrupted the CPU fewer times than ticks went by. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SHORT_SLEEP 30
+#define LONG_SLEEP 100
+
+static thread_func sleeper;
+static struct semaphore done_sema;
+static int64_t start;
+
+void
+test_alarm_tickless (void)
+{
+    int64_t elapsed, interrupts;
+    static int durations[] = { SHORT_SLEEP, LONG_SLEEP };
+
+    ASSERT (timer_tickless);
+
+    sema_init (&done_sema, 0);
+
+    /* Let the tick that is in progress finish. */
+    timer_sleep (1);
+    timer_reset_interrupt_stats ();
+    start = timer_ticks ();
+
+    thread_create ("long", PRI_DEFAULT, sleeper, &durations[1]);
+    thread_create ("short", PRI_DEFAULT, sleeper, &durations[0]);
+    sema_down (&done_sema);
+    sema_down (&done_sema);
+
+    elapsed = timer_elapsed (start);
+    interrupts = timer_interrupt_count ();
+    if (elapsed < LONG_SLEEP)
+        fail ("woke up after %"PRId64" ticks, expected at least %d",
+              elapsed, LONG_SLEEP);
+    if (interrupts >= elapsed)
+        fail ("%"PRId64" timer interrupts in %"PRId64" ticks",
+              interrupts, elapsed);
+    msg ("fewer timer interrupts than ticks");
+}
+
+static void
+sleeper (void *duration_)
+{
+    int duration = *(int *) duration_;
+    int64_t woke;
+
+    timer_sleep (duration);
+    woke = timer_elapsed (start);
+    if (woke < duration)
+        fail ("thread %s woke up after %"PRId64" ticks, expected %d",
+              thread_name (), woke, duration);
+    msg ("thread %s woke up", thread_name ());
+    sema_up (&done_sema);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-tickless) begin
+(alarm-tickless) thread short woke up
+(alarm-tickless) thread long woke up
+(alarm-tickless) fewer timer interrupts than ticks
+(alarm-tickless) end
+EOF
+pass;
@@ -0,0 +1,76 @@
+/* Reports how much time the timer interrupt spends per tick as
+   the number of sleeping threads grows.  Each sleeper repeatedly
+   sleeps for a random 1 to 64 ticks, with an occasional long
+   sleep, so that both expiry and cascading in the sleep queue
+   are exercised.  The cost should track the number of threads
+   that wake up, not the number of threads asleep. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <random.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define MEASURE_TICKS 200
+
+static thread_func sleeper;
+static struct semaphore done_sema;
+static volatile bool stop;
+
+static const int thread_counts[] = { 10, 100, 400 };
+
+void
+test_alarm_wheel_bench (void)
+{
+    size_t i;
+
+    sema_init (&done_sema, 0);
+
+    for (i = 0; i < sizeof thread_counts / sizeof *thread_counts; i++)
+        {
+            int cnt = thread_counts[i];
+            int j;
+
+            stop = false;
+            for (j = 0; j < cnt; j++)
+                {
+                    char name[16];
+                    snprintf (name, sizeof name, "sleeper %d", j);
+                    if (thread_create (name, PRI_DEFAULT, sleeper, NULL)
+                        == TID_ERROR)
+                        fail ("thread_create() failed for thread %d", j);
+                }
+
+            /* Let the sleepers spread out before measuring. */
+            timer_sleep (64);
+            timer_reset_interrupt_stats ();
+            timer_sleep (MEASURE_TICKS);
+
+            msg ("%d sleepers: %" PRIu64 " cycles/tick average, %" PRIu64
+                 " max",
+                 cnt, timer_interrupt_avg_cycles (),
+                 timer_interrupt_max_cycles ());
+
+            stop = true;
+            for (j = 0; j < cnt; j++)
+                sema_down (&done_sema);
+        }
+
+    pass ();
+}
+
+static void
+sleeper (void *aux UNUSED)
+{
+    while (!stop)
+        {
+            /* One sleep in 16 goes past the first wheel level. */
+            int ticks = random_ulong () % 16 == 0 ? 64 + random_ulong () % 64
+                                                  : 1 + random_ulong () % 64;
+            timer_sleep (ticks);
+        }
+    sema_up (&done_sema);
+}
@@ -0,0 +1,26 @@
+# -*- perl -*-
+
+# Interrupt times vary from run to run, so only check that every
+# configuration reported a result and the test passed.
+#
+# (alarm-wheel-bench) 10 sleepers: 1830 cycles/tick average, 5120 max
+# (alarm-wheel-bench) 100 sleepers: 2410 cycles/tick average, 9300 max
+# (alarm-wheel-bench) 400 sleepers: 3950 cycles/tick average, 21000 max
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/\d+ sleepers: \d+ cycles\/tick average, \d+ max/,
+		      @output);
+fail "Expected 3 results but found " . scalar (@results) . ".\n"
+  if @results != 3;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(alarm-wheel-bench\) PASS/, @output);
+
+pass;
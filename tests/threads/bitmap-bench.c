@@ -0,0 +1,121 @@
+/* Measures bitmap_count(), bitmap_contains() and bitmap_scan() on
+   a 1M-bit map that is 90% set, as a busy allocator's map would
+   be, against bit-by-bit versions built on bitmap_test() that work
+   the way the library used to.  The only run of 64 clear bits is
+   near the end of the map, so both scans cover all of it.  Reports
+   the cost per 1,024 bits examined. */
+
+#include <stdio.h>
+#include <bitmap.h>
+#include <inttypes.h>
+#include <random.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+
+#define BIT_CNT (1024 * 1024)
+#define RUN_START (BIT_CNT - 1000)
+#define RUN_LEN 64
+#define REPS 8
+
+static size_t
+ref_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+    size_t i, value_cnt = 0;
+
+    for (i = 0; i < cnt; i++)
+        if (bitmap_test (b, start + i) == value)
+            value_cnt++;
+    return value_cnt;
+}
+
+static bool
+ref_contains (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+    size_t i;
+
+    for (i = 0; i < cnt; i++)
+        if (bitmap_test (b, start + i) == value)
+            return true;
+    return false;
+}
+
+static size_t
+ref_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+    size_t last = bitmap_size (b) - cnt;
+    size_t i;
+
+    for (i = start; i <= last; i++)
+        if (!ref_contains (b, i, cnt, !value))
+            return i;
+    return BITMAP_ERROR;
+}
+
+static void
+report (const char *what, const char *how, uint64_t cycles, int reps)
+{
+    msg ("%s, %s: %" PRIu64 " cycles/kbit", what, how,
+         cycles / reps / (BIT_CNT / 1024));
+}
+
+void
+test_bitmap_bench (void)
+{
+    struct bitmap *b = bitmap_create (BIT_CNT);
+    size_t expected, i;
+    uint64_t start;
+    int r;
+
+    if (b == NULL)
+        fail ("out of memory");
+
+    /* 90% set, with no run of RUN_LEN clear bits except the one we
+       plant. */
+    random_init (0);
+    for (i = 0; i < BIT_CNT; i++)
+        bitmap_set (b, i, i % 32 == 0 || random_ulong () % 10 != 0);
+    bitmap_set_multiple (b, RUN_START, RUN_LEN, false);
+
+    /* Count. */
+    start = rdtsc ();
+    expected = ref_count (b, 0, BIT_CNT, false);
+    report ("count", "bit by bit", rdtsc () - start, 1);
+    start = rdtsc ();
+    for (r = 0; r < REPS; r++)
+        if (bitmap_count (b, 0, BIT_CNT, false) != expected)
+            fail ("bitmap_count() disagrees");
+    report ("count", "word at a time", rdtsc () - start, REPS);
+
+    /* Contains: a single clear bit at the very end. */
+    bitmap_set_all (b, true);
+    bitmap_reset (b, BIT_CNT - 1);
+    start = rdtsc ();
+    if (!ref_contains (b, 0, BIT_CNT, false))
+        fail ("reference contains() missed the clear bit");
+    report ("contains", "bit by bit", rdtsc () - start, 1);
+    start = rdtsc ();
+    for (r = 0; r < REPS; r++)
+        if (!bitmap_contains (b, 0, BIT_CNT, false))
+            fail ("bitmap_contains() missed the clear bit");
+    report ("contains", "word at a time", rdtsc () - start, REPS);
+
+    /* Scan.  Rebuild the 90% map. */
+    random_init (0);
+    for (i = 0; i < BIT_CNT; i++)
+        bitmap_set (b, i, i % 32 == 0 || random_ulong () % 10 != 0);
+    bitmap_set_multiple (b, RUN_START, RUN_LEN, false);
+    start = rdtsc ();
+    expected = ref_scan (b, 0, RUN_LEN, false);
+    report ("scan", "bit by bit", rdtsc () - start, 1);
+    if (expected != RUN_START)
+        fail ("reference scan found %zu, expected %d", expected, RUN_START);
+    start = rdtsc ();
+    for (r = 0; r < REPS; r++)
+        if (bitmap_scan (b, 0, RUN_LEN, false) != expected)
+            fail ("bitmap_scan() disagrees");
+    report ("scan", "word at a time", rdtsc () - start, REPS);
+
+    bitmap_destroy (b);
+    pass ();
+}
@@ -0,0 +1,28 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that every
+# operation reported a result and the test passed.
+#
+# (bitmap-bench) count, bit by bit: 30000 cycles/kbit
+# (bitmap-bench) count, word at a time: 500 cycles/kbit
+# (bitmap-bench) contains, bit by bit: 25000 cycles/kbit
+# (bitmap-bench) contains, word at a time: 200 cycles/kbit
+# (bitmap-bench) scan, bit by bit: 60000 cycles/kbit
+# (bitmap-bench) scan, word at a time: 3000 cycles/kbit
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/: \d+ cycles\/kbit/, @output);
+fail "Expected 6 results but found " . scalar (@results) . ".\n"
+  if @results != 6;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(bitmap-bench\) PASS/, @output);
+
+pass;
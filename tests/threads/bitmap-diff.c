@@ -0,0 +1,138 @@
+/* Checks the word-at-a-time bitmap_count(), bitmap_contains(),
+   bitmap_scan() and bitmap_set_multiple() against straightforward
+   bit-by-bit versions built on bitmap_test() and bitmap_set(), on
+   random bitmaps of random sizes and densities, so that ranges
+   start and end at every offset within an element. */
+
+#include <stdio.h>
+#include <bitmap.h>
+#include <random.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+
+#define MAP_CNT 2000
+#define QUERY_CNT 20
+#define MAX_BITS 300
+
+static size_t
+ref_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+    size_t i, value_cnt = 0;
+
+    for (i = 0; i < cnt; i++)
+        if (bitmap_test (b, start + i) == value)
+            value_cnt++;
+    return value_cnt;
+}
+
+static bool
+ref_contains (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+    size_t i;
+
+    for (i = 0; i < cnt; i++)
+        if (bitmap_test (b, start + i) == value)
+            return true;
+    return false;
+}
+
+static size_t
+ref_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+    if (cnt <= bitmap_size (b))
+        {
+            size_t last = bitmap_size (b) - cnt;
+            size_t i;
+            for (i = start; i <= last; i++)
+                if (!ref_contains (b, i, cnt, !value))
+                    return i;
+        }
+    return BITMAP_ERROR;
+}
+
+/* Returns a random number in [0, N). */
+static size_t
+pick (size_t n)
+{
+    return random_ulong () % n;
+}
+
+/* Sets CNT bits from START to VALUE and checks that exactly those
+   bits changed. */
+static void
+check_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+    size_t size = bitmap_size (b);
+    static bool before[MAX_BITS];
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        before[i] = bitmap_test (b, i);
+    bitmap_set_multiple (b, start, cnt, value);
+    for (i = 0; i < size; i++)
+        {
+            bool expected = i >= start && i < start + cnt ? value : before[i];
+            if (bitmap_test (b, i) != expected)
+                fail ("set_multiple (%zu, %zu, %d) on %zu bits: bit %zu is %d",
+                      start, cnt, value, size, i, !expected);
+        }
+}
+
+void
+test_bitmap_diff (void)
+{
+    int m, q;
+
+    random_init (0);
+    msg ("begin");
+    for (m = 0; m < MAP_CNT; m++)
+        {
+            size_t size = pick (MAX_BITS);
+            unsigned density = pick (101);
+            struct bitmap *b = bitmap_create (size);
+            size_t i;
+
+            if (b == NULL)
+                fail ("out of memory");
+            for (i = 0; i < size; i++)
+                bitmap_set (b, i, pick (100) < density);
+            if (size > 0)
+                {
+                    size_t start = pick (size + 1);
+                    check_set_multiple (b, start, pick (size - start + 1),
+                                        pick (2));
+                }
+
+            for (q = 0; q < QUERY_CNT; q++)
+                {
+                    size_t start = pick (size + 1);
+                    size_t cnt = pick (size - start + 1);
+                    bool value = pick (2);
+                    size_t expected, actual;
+
+                    expected = ref_count (b, start, cnt, value);
+                    actual = bitmap_count (b, start, cnt, value);
+                    if (actual != expected)
+                        fail ("count (%zu, %zu, %d) on %zu bits: %zu, "
+                              "expected %zu", start, cnt, value, size,
+                              actual, expected);
+
+                    if (bitmap_contains (b, start, cnt, value)
+                        != ref_contains (b, start, cnt, value))
+                        fail ("contains (%zu, %zu, %d) on %zu bits is wrong",
+                              start, cnt, value, size);
+
+                    /* Also try runs longer than the rest of the map. */
+                    cnt = pick (size - start + 8);
+                    expected = ref_scan (b, start, cnt, value);
+                    actual = bitmap_scan (b, start, cnt, value);
+                    if (actual != expected)
+                        fail ("scan (%zu, %zu, %d) on %zu bits: %zu, "
+                              "expected %zu", start, cnt, value, size,
+                              actual, expected);
+                }
+            bitmap_destroy (b);
+        }
+    msg ("%d bitmaps agree", MAP_CNT);
+    msg ("end");
+}
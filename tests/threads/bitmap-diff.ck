@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(bitmap-diff) begin
+(bitmap-diff) 2000 bitmaps agree
+(bitmap-diff) end
+EOF
+pass;
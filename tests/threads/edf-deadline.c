@@ -0,0 +1,136 @@
+/* Checks the EDF scheduling class under overload.
+
+   Three well-behaved periodic tasks declare a runtime with some
+   slack over the CPU time each job needs.  A fourth task
+   declares one tick of runtime per period but needs three, so it
+   is throttled and misses its own deadlines.  A fifth task asks
+   for more bandwidth than is left and must be rejected.
+   Meanwhile, high-priority threads in the ordinary priority
+   class try to use the whole CPU.
+
+   The well-behaved tasks must not miss a single deadline, the
+   overrunning task must miss deadlines, and the priority threads
+   must still get the CPU time the EDF tasks leave over. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define RUN_TICKS 300
+#define HOG_CNT 2
+
+struct task
+  {
+    const char *name;
+    int work_ms;                /* CPU time each job needs. */
+    int64_t runtime;            /* Declared budget per period. */
+    int64_t period;
+    bool admitted;
+    unsigned jobs, misses;
+  };
+
+static struct task tasks[] =
+  {
+    { "A", 10, 3, 10, false, 0, 0 },
+    { "B", 20, 4, 15, false, 0, 0 },
+    { "C", 10, 3, 20, false, 0, 0 },
+    { "overrun", 30, 1, 10, false, 0, 0 },
+    { "greedy", 10, 2, 10, false, 0, 0 },
+  };
+#define TASK_CNT (sizeof tasks / sizeof *tasks)
+
+static thread_func edf_task, hog;
+static struct semaphore admit_sema;
+static struct semaphore done_sema;
+static volatile bool stop;
+static volatile int64_t hog_loops;
+
+void
+test_edf_deadline (void)
+{
+    size_t i;
+    int admitted = 0;
+
+    sema_init (&admit_sema, 0);
+    sema_init (&done_sema, 0);
+
+    /* Stay above the hogs so that we can stop them. */
+    thread_set_priority (PRI_MAX);
+
+    /* Start the tasks one at a time so that admission happens in
+       order. */
+    for (i = 0; i < TASK_CNT; i++)
+        {
+            thread_create (tasks[i].name, PRI_DEFAULT, edf_task, &tasks[i]);
+            sema_down (&admit_sema);
+            if (tasks[i].admitted)
+                admitted++;
+        }
+
+    for (i = 0; i < HOG_CNT; i++)
+        thread_create ("hog", PRI_MAX - 1, hog, NULL);
+
+    timer_sleep (RUN_TICKS);
+    stop = true;
+    for (i = 0; i < (size_t) admitted + HOG_CNT; i++)
+        sema_down (&done_sema);
+
+    for (i = 0; i < TASK_CNT; i++)
+        {
+            struct task *t = &tasks[i];
+            unsigned min_jobs = RUN_TICKS / t->period / 2;
+
+            if (!t->admitted)
+                msg ("%s: rejected", t->name);
+            else if (t->runtime * 10 >= t->work_ms)
+                {
+                    if (t->misses != 0)
+                        fail ("%s: %u of %u jobs missed their deadline",
+                              t->name, t->misses, t->jobs);
+                    if (t->jobs < min_jobs)
+                        fail ("%s: only %u jobs completed", t->name, t->jobs);
+                    msg ("%s: no missed deadlines", t->name);
+                }
+            else
+                {
+                    if (t->misses == 0)
+                        fail ("%s: overran its budget but missed no deadlines",
+                              t->name);
+                    msg ("%s: missed deadlines", t->name);
+                }
+        }
+    if (hog_loops == 0)
+        fail ("priority threads never ran");
+    msg ("priority threads ran");
+}
+
+static void
+edf_task (void *task_)
+{
+    struct task *t = task_;
+
+    t->admitted = thread_set_deadline (t->runtime, t->period, 0);
+    sema_up (&admit_sema);
+    if (!t->admitted)
+        return;
+
+    while (!stop)
+        {
+            timer_mdelay (t->work_ms);
+            thread_wait_next_period ();
+        }
+    thread_get_deadline_stats (&t->jobs, &t->misses);
+    thread_clear_deadline ();
+    sema_up (&done_sema);
+}
+
+static void
+hog (void *aux UNUSED)
+{
+    while (!stop)
+        hog_loops++;
+    sema_up (&done_sema);
+}
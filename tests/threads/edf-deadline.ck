@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-deadline) begin
+(edf-deadline) A: no missed deadlines
+(edf-deadline) B: no missed deadlines
+(edf-deadline) C: no missed deadlines
+(edf-deadline) overrun: missed deadlines
+(edf-deadline) greedy: rejected
+(edf-deadline) priority threads ran
+(edf-deadline) end
+EOF
+pass;
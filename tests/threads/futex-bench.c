@@ -0,0 +1,176 @@
+/* Compares a futex-based mutex against struct lock.  Several
+   threads increment a shared counter under the lock, yielding
+   inside the critical section every so often so that the others
+   find it held; the test reports the cost per acquisition and,
+   for the futex mutex, how many acquisitions and releases had to
+   enter the futex wait queues at all.  Also checks that
+   futex_wait() refuses to sleep on a stale value and that
+   futex_wake() wakes no more than the requested number of
+   waiters.
+
+   The mutex is the same algorithm as lib/user/mutex.c, run on
+   the kernel futex API so that it can be measured here. */
+
+#include <stdio.h>
+#include <atomic.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/futex.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define THREAD_CNT 4
+#define ITER_CNT 20000
+#define YIELD_EVERY 64
+
+/* Futex mutex. */
+static volatile int fmutex;
+static int futex_calls;
+
+static void
+fmutex_lock (void)
+{
+    int state = atomic_cmpxchg (&fmutex, 0, 1);
+
+    if (state == 0)
+        return;
+    if (state != 2)
+        state = atomic_xchg (&fmutex, 2);
+    while (state != 0)
+        {
+            futex_calls++;
+            futex_wait ((int *) &fmutex, 2, -1);
+            state = atomic_xchg (&fmutex, 2);
+        }
+}
+
+static void
+fmutex_unlock (void)
+{
+    if (atomic_xchg (&fmutex, 0) == 2)
+        {
+            futex_calls++;
+            futex_wake ((int *) &fmutex, 1);
+        }
+}
+
+static struct lock lock;
+static bool use_futex;
+static int counter;
+static struct semaphore done_sema;
+
+static void
+worker (void *aux UNUSED)
+{
+    int i;
+
+    for (i = 0; i < ITER_CNT; i++)
+        {
+            if (use_futex)
+                fmutex_lock ();
+            else
+                lock_acquire (&lock);
+
+            counter++;
+            if (i % YIELD_EVERY == 0)
+                thread_yield ();
+
+            if (use_futex)
+                fmutex_unlock ();
+            else
+                lock_release (&lock);
+        }
+    sema_up (&done_sema);
+}
+
+static void
+bench (bool futex)
+{
+    uint64_t start, cycles;
+    int i;
+
+    use_futex = futex;
+    counter = futex_calls = 0;
+    fmutex = 0;
+    lock_init (&lock);
+    sema_init (&done_sema, 0);
+
+    start = rdtsc ();
+    for (i = 0; i < THREAD_CNT; i++)
+        thread_create ("worker", PRI_DEFAULT, worker, NULL);
+    for (i = 0; i < THREAD_CNT; i++)
+        sema_down (&done_sema);
+    cycles = rdtsc () - start;
+
+    if (counter != THREAD_CNT * ITER_CNT)
+        fail ("counter is %d, expected %d", counter, THREAD_CNT * ITER_CNT);
+    if (futex)
+        msg ("futex mutex: %" PRIu64 " cycles/acquire, %d futex calls",
+             cycles / (THREAD_CNT * ITER_CNT), futex_calls);
+    else
+        msg ("lock: %" PRIu64 " cycles/acquire",
+             cycles / (THREAD_CNT * ITER_CNT));
+}
+
+/* Wake-N check. */
+#define WAITER_CNT 5
+
+static int word;
+static int woken_cnt;
+
+static void
+waiter (void *aux UNUSED)
+{
+    if (futex_wait (&word, 0, -1))
+        woken_cnt++;
+    sema_up (&done_sema);
+}
+
+static void
+check_semantics (void)
+{
+    int i;
+
+    word = 1;
+    if (futex_wait (&word, 0, -1))
+        fail ("futex_wait() slept on a stale value");
+    if (futex_wake (&word, 1) != 0)
+        fail ("futex_wake() woke a thread with no waiters");
+    if (futex_wait (&word, 1, 2))
+        fail ("futex_wait() reported a wakeup after timing out");
+
+    /* Waiters run at a higher priority, so each blocks in
+       futex_wait() before thread_create() returns. */
+    word = 0;
+    woken_cnt = 0;
+    sema_init (&done_sema, 0);
+    for (i = 0; i < WAITER_CNT; i++)
+        thread_create ("waiter", PRI_DEFAULT + 1, waiter, NULL);
+
+    if (futex_wake (&word, 2) != 2)
+        fail ("futex_wake() did not wake 2 waiters");
+    sema_down (&done_sema);
+    sema_down (&done_sema);
+    if (woken_cnt != 2)
+        fail ("%d waiters woke, expected 2", woken_cnt);
+
+    if (futex_wake (&word, WAITER_CNT) != WAITER_CNT - 2)
+        fail ("futex_wake() did not wake the remaining waiters");
+    for (i = 2; i < WAITER_CNT; i++)
+        sema_down (&done_sema);
+    if (woken_cnt != WAITER_CNT)
+        fail ("%d waiters woke, expected %d", woken_cnt, WAITER_CNT);
+}
+
+void
+test_futex_bench (void)
+{
+    ASSERT (!thread_mlfqs);
+
+    check_semantics ();
+    bench (false);
+    bench (true);
+    pass ();
+}
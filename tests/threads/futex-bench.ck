@@ -0,0 +1,24 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that both locks
+# reported a result and the test passed.
+#
+# (futex-bench) lock: 900 cycles/acquire
+# (futex-bench) futex mutex: 300 cycles/acquire, 2500 futex calls
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/: \d+ cycles\/acquire/, @output);
+fail "Expected 2 results but found " . scalar (@results) . ".\n"
+  if @results != 2;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(futex-bench\) PASS/, @output);
+
+pass;
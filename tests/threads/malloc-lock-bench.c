@@ -0,0 +1,85 @@
+/* Runs four threads of equal priority that malloc() and free()
+   blocks of the same size, so that they share one descriptor
+   lock, first with adaptive locking turned off and then with it
+   on.  Each thread allocates a burst of blocks larger than a
+   per-CPU magazine before freeing them, so that the magazine
+   keeps going back to the descriptor.  Reports the cost per malloc()/free() pair and how often a
+   contended acquire got the lock by yielding to the holder
+   instead of blocking.  Contention comes from the timer
+   preempting a thread inside malloc(). */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define THREAD_CNT 4
+#define ITER_CNT 100000
+#define BURST_CNT 50
+#define BLOCK_SIZE 48
+
+static struct semaphore done_sema;
+
+static void
+worker (void *aux UNUSED)
+{
+    void *blocks[BURST_CNT];
+    int i, j;
+
+    for (i = 0; i < ITER_CNT; i += BURST_CNT)
+        {
+            for (j = 0; j < BURST_CNT; j++)
+                {
+                    blocks[j] = malloc (BLOCK_SIZE);
+                    if (blocks[j] == NULL)
+                        fail ("malloc() failed");
+                }
+            for (j = 0; j < BURST_CNT; j++)
+                free (blocks[j]);
+        }
+    sema_up (&done_sema);
+}
+
+static void
+run (const char *how, unsigned spin_limit)
+{
+    struct lock_spin_stats before, after;
+    unsigned long long contended, acquired;
+    uint64_t start, cycles;
+    int i;
+
+    lock_set_spin_limit (spin_limit);
+    lock_get_spin_stats (&before);
+    start = rdtsc ();
+    for (i = 0; i < THREAD_CNT; i++)
+        if (thread_create ("worker", PRI_DEFAULT, worker, NULL) == TID_ERROR)
+            fail ("thread_create() failed");
+    for (i = 0; i < THREAD_CNT; i++)
+        sema_down (&done_sema);
+    cycles = rdtsc () - start;
+    lock_get_spin_stats (&after);
+
+    acquired = after.acquired - before.acquired;
+    contended = acquired + after.blocked - before.blocked;
+    msg ("%s: %" PRIu64 " cycles/op, %llu of %llu contended acquires "
+         "without blocking", how, cycles / (THREAD_CNT * ITER_CNT),
+         acquired, contended);
+}
+
+void
+test_malloc_lock_bench (void)
+{
+    unsigned spin_limit = lock_get_spin_limit ();
+
+    ASSERT (!thread_mlfqs);
+
+    sema_init (&done_sema, 0);
+    run ("blocking", 0);
+    run ("adaptive", spin_limit > 0 ? spin_limit : 4);
+    lock_set_spin_limit (spin_limit);
+    pass ();
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+
+# Timings and contention vary from run to run, so only check that
+# both modes reported a result and the test passed.
+#
+# (malloc-lock-bench) blocking: 610 cycles/op, 0 of 14 contended acquires without blocking
+# (malloc-lock-bench) adaptive: 560 cycles/op, 13 of 14 contended acquires without blocking
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/: \d+ cycles\/op, \d+ of \d+ contended acquires/, @output);
+fail "Expected 2 results but found " . scalar (@results) . ".\n"
+  if @results != 2;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(malloc-lock-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,148 @@
+/* Runs the same random mix of malloc() and free() calls of 1 to
+   1024 bytes in 1, 2 and then 4 threads of equal priority, and
+   reports the cost per call and how often the per-CPU magazines
+   had to go to a descriptor's lock to refill or drain.
+
+   With every thread holding its live blocks, reports how much
+   memory they take: the bytes requested, the bytes in the blocks
+   that malloc() rounded them up to, and the arena pages behind
+   them, including blocks sitting on free lists and in magazines.
+   Afterward, checks that freeing everything leaves no block in
+   use. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <random.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+#define THREAD_MAX 4
+#define OP_CNT 20000
+#define SLOT_CNT 64
+
+/* Operation I toggles slot op_slot[I]: if the slot is empty, it
+   allocates op_size[I] bytes, otherwise it frees the block. */
+static uint8_t op_slot[OP_CNT];
+static uint16_t op_size[OP_CNT];
+
+struct slot
+{
+    void *block;                /* Null if empty. */
+    size_t size;                /* Bytes requested. */
+};
+
+static struct slot slots[THREAD_MAX][SLOT_CNT];
+static struct semaphore done_sema;
+static struct semaphore release_sema;
+
+static void
+worker (void *slots_)
+{
+    struct slot *slots = slots_;
+    int i;
+
+    for (i = 0; i < OP_CNT; i++)
+        {
+            struct slot *s = &slots[op_slot[i]];
+
+            if (s->block == NULL)
+                {
+                    s->block = malloc (op_size[i]);
+                    if (s->block == NULL)
+                        fail ("malloc() failed");
+                    s->size = op_size[i];
+                }
+            else
+                {
+                    free (s->block);
+                    s->block = NULL;
+                }
+        }
+
+    /* Hold on to the live blocks until the main thread has
+       measured them. */
+    sema_up (&done_sema);
+    sema_down (&release_sema);
+
+    for (i = 0; i < SLOT_CNT; i++)
+        if (slots[i].block != NULL)
+            {
+                free (slots[i].block);
+                slots[i].block = NULL;
+            }
+    sema_up (&done_sema);
+}
+
+static void
+run (int thread_cnt)
+{
+    struct malloc_stats before, during, after;
+    uint64_t start, cycles;
+    size_t requested = 0;
+    int i, j;
+
+    sema_init (&done_sema, 0);
+    sema_init (&release_sema, 0);
+    malloc_get_stats (&before);
+
+    start = rdtsc ();
+    for (i = 0; i < thread_cnt; i++)
+        if (thread_create ("worker", PRI_DEFAULT, worker, slots[i])
+            == TID_ERROR)
+            fail ("thread_create() failed");
+    for (i = 0; i < thread_cnt; i++)
+        sema_down (&done_sema);
+    cycles = rdtsc () - start;
+    malloc_get_stats (&during);
+
+    for (i = 0; i < thread_cnt; i++)
+        for (j = 0; j < SLOT_CNT; j++)
+            if (slots[i][j].block != NULL)
+                requested += slots[i][j].size;
+
+    for (i = 0; i < thread_cnt; i++)
+        sema_up (&release_sema);
+    for (i = 0; i < thread_cnt; i++)
+        sema_down (&done_sema);
+    malloc_get_stats (&after);
+
+    msg ("%d threads: %" PRIu64 " cycles/op, %llu refills, %llu drains",
+         thread_cnt, cycles / (thread_cnt * OP_CNT),
+         during.refills - before.refills, during.drains - before.drains);
+    msg ("%d threads: %zu bytes requested in %zu bytes of blocks, "
+         "%zu arenas (%zu bytes), %zu bytes free, %zu bytes cached",
+         thread_cnt, requested, during.used_bytes - before.used_bytes,
+         during.arenas, during.arenas * PGSIZE, during.free_bytes,
+         during.cached_bytes);
+
+    if (after.used_bytes != before.used_bytes)
+        fail ("%zu bytes in use after freeing everything, expected %zu",
+              after.used_bytes, before.used_bytes);
+}
+
+void
+test_malloc_mag_bench (void)
+{
+    int i;
+
+    ASSERT (!thread_mlfqs);
+
+    /* Small requests are the common case, so pick the size range
+       first and then a size within it. */
+    random_init (0);
+    for (i = 0; i < OP_CNT; i++)
+        {
+            op_slot[i] = random_ulong () % SLOT_CNT;
+            op_size[i] = 1 + random_ulong () % (16 << random_ulong () % 7);
+        }
+
+    run (1);
+    run (2);
+    run (4);
+    pass ();
+}
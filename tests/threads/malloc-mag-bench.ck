@@ -0,0 +1,29 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that each thread
+# count reported its results and the test passed.
+#
+# (malloc-mag-bench) 1 threads: 150 cycles/op, 120 refills, 110 drains
+# (malloc-mag-bench) 1 threads: 9000 bytes requested in 13000 bytes of blocks, 9 arenas (36864 bytes), 15000 bytes free, 4000 bytes cached
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/threads: \d+ cycles\/op, \d+ refills, \d+ drains/,
+                      @output);
+fail "Expected 3 results but found " . scalar (@results) . ".\n"
+  if @results != 3;
+my (@reports) = grep (/threads: \d+ bytes requested in \d+ bytes of blocks/,
+                      @output);
+fail "Expected 3 fragmentation reports but found " . scalar (@reports) . ".\n"
+  if @reports != 3;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(malloc-mag-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,130 @@
+# -*- perl -*-
+
+# Helpers for checking the MLFQS tests against a simulation of
+# the 4.4BSD scheduler.
+
+use strict;
+use warnings;
+
+# Simulates 30 seconds of 4.4BSD scheduling for threads with the
+# given nice values, which all become runnable at the same time,
+# and returns the number of ticks each thread is expected to get.
+sub mlfqs_expected_ticks {
+    my (@nice) = @_;
+    my ($thread_cnt) = scalar (@nice);
+    my (@recent_cpu) = (0) x $thread_cnt;
+    my (@slices) = (0) x $thread_cnt;
+    my (@fifo) = (0) x $thread_cnt;
+    my ($next_fifo) = 1;
+    my ($load_avg) = 0;
+    for my $i (1...750) {
+	if ($i % 25 == 0) {
+	    # Update load average.
+	    $load_avg = (59/60) * $load_avg + (1/60) * $thread_cnt;
+
+	    # Update recent_cpu.
+	    my ($twice_load) = $load_avg * 2;
+	    my ($load_factor) = $twice_load / ($twice_load + 1);
+	    $recent_cpu[$_] = $recent_cpu[$_] * $load_factor + $nice[$_]
+	      foreach 0...($thread_cnt - 1);
+	}
+
+	# Update priorities.  Lower values here mean higher priority.
+	my (@priority);
+	foreach my $j (0...($thread_cnt - 1)) {
+	    my ($priority) = int ($recent_cpu[$j] / 4 + $nice[$j] * 2);
+	    $priority = 0 if $priority < 0;
+	    $priority = 63 if $priority > 63;
+	    push (@priority, $priority);
+	}
+
+	# Choose thread to run.
+	my $max = 0;
+	for my $j (1...$#priority) {
+	    if ($priority[$j] < $priority[$max]
+		|| ($priority[$j] == $priority[$max]
+		    && $fifo[$j] < $fifo[$max])) {
+		$max = $j;
+	    }
+	}
+	$fifo[$max] = $next_fifo++;
+
+	# Run thread for one time slice.
+	$recent_cpu[$max] += 4;
+	$slices[$max] += 4;
+    }
+    return @slices;
+}
+
+# Compares @$ACTUAL_REF against @$EXPECTED_REF at the indexes
+# given by T_RANGE = [min, max, step].  Fails with MESSAGE and a
+# table of the differences if any value is missing or differs by
+# more than MAX_DIFF.
+sub mlfqs_compare {
+    local ($_);
+    my ($indep_var, $format,
+	$actual_ref, $expected_ref, $max_diff, $t_range, $message) = @_;
+    my ($t_min, $t_max, $t_step) = @$t_range;
+
+    my ($ok) = 1;
+    for (my ($t) = $t_min; $t <= $t_max; $t += $t_step) {
+	my ($actual) = $actual_ref->[$t];
+	my ($expected) = $expected_ref->[$t];
+	$ok = 0, last
+	  if !defined ($actual) || abs ($actual - $expected) > $max_diff + .01;
+    }
+    return if $ok;
+
+    print "$message\n";
+    mlfqs_row ($indep_var, "actual", "<->", "expected", "explanation");
+    mlfqs_row ("------", "--------", "---", "--------", '-' x 40);
+    for (my ($t) = $t_min; $t <= $t_max; $t += $t_step) {
+	my ($actual) = $actual_ref->[$t];
+	my ($expected) = $expected_ref->[$t];
+	my ($diff) = defined $actual ? abs ($actual - $expected) : undef;
+	my ($rationale);
+	if (!defined $actual) {
+	    $actual = 'undef';
+	    $rationale = "Missing value.";
+	} elsif ($diff > $max_diff + .01) {
+	    $rationale = sprintf ("Too big, by $format.", $diff - $max_diff);
+	    $actual = sprintf ($format, $actual);
+	} else {
+	    $rationale = '';
+	    $actual = sprintf ($format, $actual);
+	}
+	mlfqs_row ($t, $actual, '', sprintf ($format, $expected), $rationale);
+    }
+    fail ();
+}
+
+sub mlfqs_row {
+    printf "%6s %8s %3s %-8s %s\n", @_;
+}
+
+# Checks the output of one of the mlfqs-fair or mlfqs-nice tests,
+# run with threads of the given @$NICE values, against the
+# simulated tick counts.
+sub check_mlfqs_fair {
+    my ($nice, $maxdiff) = @_;
+    our ($test);
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+
+    my (@actual);
+    local ($_);
+    foreach (@output) {
+	my ($id, $count) = /Thread (\d+) received (\d+) ticks\./ or next;
+	$actual[$id] = $count;
+    }
+
+    my (@expected) = mlfqs_expected_ticks (@$nice);
+    mlfqs_compare ("thread", "%d",
+		   \@actual, \@expected, $maxdiff, [0, $#$nice, 1],
+		   "Some tick counts were missing or differed from those "
+		   . "expected by more than $maxdiff.");
+    pass ();
+}
+
+1;
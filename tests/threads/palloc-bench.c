@@ -0,0 +1,170 @@
+/* Runs the same random mix of 1 to 64 page allocations and frees
+   against a first-fit bitmap allocator, which is how palloc used
+   to work, and against palloc's buddy allocator, and reports the
+   cost of each.  The first-fit allocator only manages a private
+   bitmap, so its numbers exclude the cost of touching memory;
+   palloc's frees also fill the pages with 0xcc in debug builds.
+   Afterward, checks that freeing everything merges the user pool
+   back into the blocks it started with. */
+
+#include <stdio.h>
+#include <bitmap.h>
+#include <inttypes.h>
+#include <random.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+
+#define OP_CNT 20000
+#define SLOT_CNT 96
+#define MAX_PAGES 64
+
+/* Operation I toggles slot op_slot[I]: if the slot is empty, it
+   allocates op_pages[I] pages, otherwise it frees them. */
+static uint8_t op_slot[OP_CNT];
+static uint8_t op_pages[OP_CNT];
+
+struct slot
+{
+    size_t page_cnt;            /* 0 if empty. */
+    size_t idx;                 /* First-fit: first page index. */
+    void *pages;                /* Buddy: first page. */
+};
+
+static struct slot slots[SLOT_CNT];
+
+static void
+report (const char *how, uint64_t alloc_cycles, int allocs,
+        uint64_t free_cycles, int frees, int failed)
+{
+    msg ("%s: %" PRIu64 " cycles/alloc, %" PRIu64 " cycles/free, "
+         "%d failed", how, alloc_cycles / allocs, free_cycles / frees,
+         failed);
+}
+
+static void
+bench_first_fit (size_t page_cnt)
+{
+    struct bitmap *map = bitmap_create (page_cnt);
+    uint64_t alloc_cycles = 0, free_cycles = 0, start;
+    int allocs = 0, frees = 0, failed = 0;
+    int i;
+
+    if (map == NULL)
+        fail ("out of memory");
+    for (i = 0; i < OP_CNT; i++)
+        {
+            struct slot *s = &slots[op_slot[i]];
+
+            start = rdtsc ();
+            if (s->page_cnt == 0)
+                {
+                    s->idx = bitmap_scan_and_flip (map, 0, op_pages[i], false);
+                    if (s->idx != BITMAP_ERROR)
+                        s->page_cnt = op_pages[i];
+                    else
+                        failed++;
+                    alloc_cycles += rdtsc () - start;
+                    allocs++;
+                }
+            else
+                {
+                    bitmap_set_multiple (map, s->idx, s->page_cnt, false);
+                    s->page_cnt = 0;
+                    free_cycles += rdtsc () - start;
+                    frees++;
+                }
+        }
+    for (i = 0; i < SLOT_CNT; i++)
+        if (slots[i].page_cnt != 0)
+            {
+                bitmap_set_multiple (map, slots[i].idx, slots[i].page_cnt, false);
+                slots[i].page_cnt = 0;
+            }
+    bitmap_destroy (map);
+
+    report ("first-fit bitmap", alloc_cycles, allocs, free_cycles, frees,
+            failed);
+}
+
+static void
+bench_buddy (void)
+{
+    struct palloc_stats before, during, after;
+    uint64_t alloc_cycles = 0, free_cycles = 0, start;
+    int allocs = 0, frees = 0, failed = 0;
+    int i;
+
+    palloc_get_stats (PAL_USER, &before);
+    for (i = 0; i < OP_CNT; i++)
+        {
+            struct slot *s = &slots[op_slot[i]];
+
+            start = rdtsc ();
+            if (s->page_cnt == 0)
+                {
+                    s->pages = palloc_get_multiple (PAL_USER, op_pages[i]);
+                    if (s->pages != NULL)
+                        s->page_cnt = op_pages[i];
+                    else
+                        failed++;
+                    alloc_cycles += rdtsc () - start;
+                    allocs++;
+                }
+            else
+                {
+                    palloc_free_multiple (s->pages, s->page_cnt);
+                    s->page_cnt = 0;
+                    free_cycles += rdtsc () - start;
+                    frees++;
+                }
+        }
+
+    palloc_get_stats (PAL_USER, &during);
+    for (i = 0; i < SLOT_CNT; i++)
+        if (slots[i].page_cnt != 0)
+            {
+                palloc_free_multiple (slots[i].pages, slots[i].page_cnt);
+                slots[i].page_cnt = 0;
+            }
+    palloc_get_stats (PAL_USER, &after);
+
+    report ("buddy", alloc_cycles, allocs, free_cycles, frees, failed);
+    msg ("buddy: largest free block %zu of %zu free pages, %llu scans",
+         during.largest_free, during.free_pages,
+         during.scans - before.scans);
+
+    if (after.free_pages != before.free_pages)
+        fail ("%zu pages free after freeing everything, expected %zu",
+              after.free_pages, before.free_pages);
+    for (i = 0; i < PALLOC_ORDERS; i++)
+        if (after.free_blocks[i] != before.free_blocks[i])
+            fail ("%zu free blocks of %d pages after freeing everything, "
+                  "expected %zu", after.free_blocks[i], 1 << i,
+                  before.free_blocks[i]);
+}
+
+void
+test_palloc_bench (void)
+{
+    struct palloc_stats stats;
+    int i;
+
+    palloc_get_stats (PAL_USER, &stats);
+    if (stats.total_pages < SLOT_CNT * MAX_PAGES / 2)
+        fail ("user pool has only %zu pages", stats.total_pages);
+
+    random_init (0);
+    for (i = 0; i < OP_CNT; i++)
+        {
+            op_slot[i] = random_ulong () % SLOT_CNT;
+            op_pages[i] = 1 + random_ulong () % MAX_PAGES;
+        }
+
+    bench_first_fit (stats.total_pages);
+    bench_buddy ();
+    pass ();
+}
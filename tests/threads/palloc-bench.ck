@@ -0,0 +1,25 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that both
+# allocators reported a result and the test passed.
+#
+# (palloc-bench) first-fit bitmap: 9000 cycles/alloc, 300 cycles/free, 12 failed
+# (palloc-bench) buddy: 900 cycles/alloc, 60000 cycles/free, 20 failed
+# (palloc-bench) buddy: largest free block 512 of 1900 free pages, 150 scans
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/: \d+ cycles\/alloc, \d+ cycles\/free/, @output);
+fail "Expected 2 results but found " . scalar (@results) . ".\n"
+  if @results != 2;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(palloc-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,148 @@
+/* Sorts 16,384 random integers with 1, 2, 4 and 8 threads.  Each
+   thread sorts its own chunk, then pairs of sorted runs are
+   merged in log2(threads) rounds, with a barrier between phases
+   and a latch to tell the main thread that the sort is done.
+   Reports the time for the whole sort and, from a separate run
+   of empty phases, the cost of one barrier phase, for each
+   thread count.  Checks that the result is sorted. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <random.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define ELEM_CNT 16384
+#define THREAD_MAX 8
+#define EMPTY_PHASES 1000
+
+static int *array;
+static int *tmp;
+static int thread_cnt;
+static struct barrier phase_barrier;
+static struct latch done_latch;
+
+static int
+compare_ints (const void *a_, const void *b_)
+{
+    const int *a = a_;
+    const int *b = b_;
+
+    return *a < *b ? -1 : *a > *b;
+}
+
+/* Merges the sorted runs A[0...CNT) and A[CNT...2*CNT) into
+   A[0...2*CNT), using T as scratch space. */
+static void
+merge (int *a, int *t, size_t cnt)
+{
+    size_t i = 0, j = cnt, k = 0;
+
+    while (i < cnt && j < 2 * cnt)
+        t[k++] = a[j] < a[i] ? a[j++] : a[i++];
+    while (i < cnt)
+        t[k++] = a[i++];
+    while (j < 2 * cnt)
+        t[k++] = a[j++];
+    memcpy (a, t, 2 * cnt * sizeof *a);
+}
+
+static void
+sorter (void *id_)
+{
+    int id = (int) id_;
+    size_t chunk = ELEM_CNT / thread_cnt;
+    int run;
+
+    qsort (array + id * chunk, chunk, sizeof *array, compare_ints);
+    barrier_wait (&phase_barrier);
+
+    /* In the round that merges runs of RUN chunks, the thread that
+       owns the first chunk of each pair of runs merges them. */
+    for (run = 1; run < thread_cnt; run *= 2)
+        {
+            if (id % (2 * run) == 0)
+                merge (array + id * chunk, tmp + id * chunk, run * chunk);
+            barrier_wait (&phase_barrier);
+        }
+    latch_count_down (&done_latch);
+}
+
+static void
+empty_phases (void *aux UNUSED)
+{
+    int i;
+
+    for (i = 0; i < EMPTY_PHASES; i++)
+        barrier_wait (&phase_barrier);
+    latch_count_down (&done_latch);
+}
+
+/* Runs FUNC in THREAD_CNT threads, each passed its index, and
+   returns the cycles until all of them counted down. */
+static uint64_t
+run_threads (thread_func *func)
+{
+    uint64_t start;
+    int i;
+
+    barrier_init (&phase_barrier, thread_cnt);
+    latch_init (&done_latch, thread_cnt);
+    start = rdtsc ();
+    for (i = 0; i < thread_cnt; i++)
+        if (thread_create ("sorter", PRI_DEFAULT, func, (void *) i) == TID_ERROR)
+            fail ("thread_create() failed");
+    latch_wait (&done_latch);
+    if (!latch_done (&done_latch))
+        fail ("latch_wait() returned before the count reached zero");
+    return rdtsc () - start;
+}
+
+void
+test_par_sort_bench (void)
+{
+    ASSERT (!thread_mlfqs);
+
+    array = malloc (ELEM_CNT * sizeof *array);
+    tmp = malloc (ELEM_CNT * sizeof *tmp);
+    if (array == NULL || tmp == NULL)
+        fail ("out of memory");
+
+    random_init (0);
+    for (thread_cnt = 1; thread_cnt <= THREAD_MAX; thread_cnt *= 2)
+        {
+            uint64_t sort_cycles, phase_cycles;
+            unsigned long long sum = 0, sorted_sum = 0;
+            int i;
+
+            for (i = 0; i < ELEM_CNT; i++)
+                {
+                    array[i] = random_ulong () % 1000000;
+                    sum += array[i];
+                }
+            sort_cycles = run_threads (sorter);
+            for (i = 0; i < ELEM_CNT; i++)
+                {
+                    if (i > 0 && array[i - 1] > array[i])
+                        fail ("%d threads: elements %d and %d out of order",
+                              thread_cnt, i - 1, i);
+                    sorted_sum += array[i];
+                }
+            if (sorted_sum != sum)
+                fail ("%d threads: sort lost or duplicated elements", thread_cnt);
+
+            phase_cycles = run_threads (empty_phases) / EMPTY_PHASES;
+            msg ("%d threads: sort %" PRIu64 " kcycles, %" PRIu64
+                 " cycles/phase", thread_cnt, sort_cycles / 1000, phase_cycles);
+        }
+
+    free (array);
+    free (tmp);
+    pass ();
+}
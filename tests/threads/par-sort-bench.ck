@@ -0,0 +1,26 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that every thread
+# count reported a result and the test passed.
+#
+# (par-sort-bench) 1 threads: sort 9800 kcycles, 150 cycles/phase
+# (par-sort-bench) 2 threads: sort 9900 kcycles, 2900 cycles/phase
+# (par-sort-bench) 4 threads: sort 10100 kcycles, 5800 cycles/phase
+# (par-sort-bench) 8 threads: sort 10300 kcycles, 11600 cycles/phase
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/\d+ threads: sort \d+ kcycles, \d+ cycles\/phase/, @output);
+fail "Expected 4 results but found " . scalar (@results) . ".\n"
+  if @results != 4;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(par-sort-bench\) PASS/, @output);
+
+pass;
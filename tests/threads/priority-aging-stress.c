@@ -0,0 +1,68 @@
+/* Measures the longest timer interrupt while many threads sit in
+   the ready queues and age.  Aging must not walk the ready
+   queues, so the worst-case handler time with 500 ready threads
+   should be about the same as with a handful. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SPIN_TICKS 64
+
+static thread_func worker;
+static struct semaphore done_sema;
+
+static const int thread_counts[] = { 5, 500 };
+
+void
+test_priority_aging_stress (void)
+{
+    size_t i;
+
+    ASSERT (!thread_mlfqs);
+
+    sema_init (&done_sema, 0);
+    thread_set_priority (PRI_MAX);
+
+    for (i = 0; i < sizeof thread_counts / sizeof *thread_counts; i++)
+        {
+            int cnt = thread_counts[i];
+            int64_t start;
+            int j;
+
+            /* Workers start at or below PRI_DEFAULT, so SPIN_TICKS
+               ticks of aging cannot lift them to our level. */
+            for (j = 0; j < cnt; j++)
+                {
+                    char name[16];
+                    snprintf (name, sizeof name, "ager %d", j);
+                    if (thread_create (name, PRI_MIN + j % (PRI_DEFAULT + 1),
+                                       worker, NULL) == TID_ERROR)
+                        fail ("thread_create() failed for thread %d", j);
+                }
+
+            timer_reset_interrupt_stats ();
+            start = timer_ticks ();
+            while (timer_elapsed (start) < SPIN_TICKS)
+                continue;
+
+            msg ("%d ready threads: max timer interrupt %" PRIu64 " cycles",
+                 cnt, timer_interrupt_max_cycles ());
+
+            for (j = 0; j < cnt; j++)
+                sema_down (&done_sema);
+        }
+
+    thread_set_priority (PRI_DEFAULT);
+    pass ();
+}
+
+static void
+worker (void *aux UNUSED)
+{
+    sema_up (&done_sema);
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+
+# Handler times vary from run to run, so only check that both
+# configurations reported a result and the test passed.
+#
+# (priority-aging-stress) 5 ready threads: max timer interrupt 2104 cycles
+# (priority-aging-stress) 500 ready threads: max timer interrupt 2230 cycles
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/\d+ ready threads: max timer interrupt \d+ cycles/,
+		      @output);
+fail "Expected 2 results but found " . scalar (@results) . ".\n"
+  if @results != 2;
+fail "Stress test did not report PASS.\n"
+  if !grep (/\(priority-aging-stress\) PASS/, @output);
+
+pass;
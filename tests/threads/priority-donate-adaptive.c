@@ -0,0 +1,73 @@
+/* Checks priority donation for an adaptive lock that changes
+   hands while a woken waiter is still on its way to take it.
+
+   The main thread holds the lock while a higher-priority waiter
+   blocks on it and a spinner of the same priority yields to the
+   main thread instead of blocking.  When the main thread
+   releases the lock and wakes the waiter, the spinner runs first
+   and takes the lock.  The spinner then drops its own priority
+   below the main thread's.  The waiter must donate to it again
+   when it finds the lock taken, or the spinner never runs again
+   while the main thread is ready and the waiter stays stuck
+   behind it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func waiter_func;
+static thread_func spinner_func;
+
+static struct lock lock;
+
+void
+test_priority_donate_adaptive (void)
+{
+    unsigned spin_limit = lock_get_spin_limit ();
+
+    /* This test does not work with the MLFQS. */
+    ASSERT (!thread_mlfqs);
+
+    /* Make sure our priority is the default. */
+    ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+    if (spin_limit == 0)
+        lock_set_spin_limit (4);
+    lock_init_adaptive (&lock);
+    lock_acquire (&lock);
+
+    thread_create ("waiter", PRI_DEFAULT + 1, waiter_func, NULL);
+    msg ("Main thread should have priority %d.  Actual priority: %d.",
+         PRI_DEFAULT + 1, thread_get_priority ());
+
+    /* The spinner has our donated priority, so it does not preempt
+       us, and yields back to us once it finds the lock held. */
+    thread_create ("spinner", PRI_DEFAULT + 1, spinner_func, NULL);
+    thread_yield ();
+
+    lock_release (&lock);
+    msg ("Main thread should have priority %d.  Actual priority: %d.",
+         PRI_DEFAULT, thread_get_priority ());
+    lock_set_spin_limit (spin_limit);
+}
+
+static void
+waiter_func (void *aux UNUSED)
+{
+    lock_acquire (&lock);
+    msg ("Waiter got the lock.");
+    lock_release (&lock);
+}
+
+static void
+spinner_func (void *aux UNUSED)
+{
+    lock_acquire (&lock);
+    msg ("Spinner got the lock.");
+    thread_set_priority (PRI_DEFAULT - 10);
+    msg ("Spinner should have priority %d.  Actual priority: %d.",
+         PRI_DEFAULT + 1, thread_get_priority ());
+    lock_release (&lock);
+}
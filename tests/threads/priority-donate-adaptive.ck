@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-adaptive) begin
+(priority-donate-adaptive) Main thread should have priority 32.  Actual priority: 32.
+(priority-donate-adaptive) Spinner got the lock.
+(priority-donate-adaptive) Spinner should have priority 32.  Actual priority: 32.
+(priority-donate-adaptive) Waiter got the lock.
+(priority-donate-adaptive) Main thread should have priority 31.  Actual priority: 31.
+(priority-donate-adaptive) end
+EOF
+pass;
@@ -0,0 +1,88 @@
+/* Checks that lock_try_acquire() takes over the donations of the
+   threads still waiting on the lock.
+
+   The main thread holds a lock that a mid-priority waiter and a
+   high-priority waiter with a timeout are blocked on.  When the
+   main thread releases it, a try-acquirer runs before the woken
+   high-priority waiter and takes the lock.  The try-acquirer
+   then drops its own priority, and the high-priority waiter
+   times out and withdraws its donation.  The mid-priority
+   waiter's donation must still hold the try-acquirer up, or the
+   mid-priority waiter is stuck behind it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HIGH_TIMEOUT 20
+
+static thread_func mid_func;
+static thread_func high_func;
+static thread_func try_func;
+
+static struct lock lock;
+static struct semaphore done_sema;
+
+void
+test_priority_donate_try (void)
+{
+    /* This test does not work with the MLFQS. */
+    ASSERT (!thread_mlfqs);
+
+    /* Make sure our priority is the default. */
+    ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+    lock_init (&lock);
+    sema_init (&done_sema, 0);
+    lock_acquire (&lock);
+
+    thread_create ("mid", PRI_DEFAULT + 1, mid_func, NULL);
+    thread_create ("high", PRI_DEFAULT + 2, high_func, NULL);
+    msg ("Main thread should have priority %d.  Actual priority: %d.",
+         PRI_DEFAULT + 2, thread_get_priority ());
+
+    /* The try-acquirer has our donated priority, so it does not
+       preempt us, and runs ahead of the waiter we wake. */
+    thread_create ("try", PRI_DEFAULT + 2, try_func, NULL);
+    lock_release (&lock);
+
+    sema_down (&done_sema);
+    msg ("Main thread should have priority %d.  Actual priority: %d.",
+         PRI_DEFAULT, thread_get_priority ());
+}
+
+static void
+mid_func (void *aux UNUSED)
+{
+    lock_acquire (&lock);
+    msg ("Mid waiter got the lock.");
+    lock_release (&lock);
+}
+
+static void
+high_func (void *aux UNUSED)
+{
+    if (lock_acquire_timeout (&lock, HIGH_TIMEOUT))
+        fail ("high waiter got the lock");
+    msg ("High waiter timed out.");
+}
+
+static void
+try_func (void *aux UNUSED)
+{
+    if (!lock_try_acquire (&lock))
+        fail ("lock_try_acquire() failed on a released lock");
+    msg ("Try-acquirer got the lock.");
+
+    /* Let the high waiter block again and then time out. */
+    thread_set_priority (PRI_DEFAULT - 10);
+    timer_sleep (HIGH_TIMEOUT + 10);
+    msg ("Try-acquirer should have priority %d.  Actual priority: %d.",
+         PRI_DEFAULT + 1, thread_get_priority ());
+
+    lock_release (&lock);
+    sema_up (&done_sema);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-try) begin
+(priority-donate-try) Main thread should have priority 33.  Actual priority: 33.
+(priority-donate-try) Try-acquirer got the lock.
+(priority-donate-try) High waiter timed out.
+(priority-donate-try) Try-acquirer should have priority 32.  Actual priority: 32.
+(priority-donate-try) Mid waiter got the lock.
+(priority-donate-try) Main thread should have priority 31.  Actual priority: 31.
+(priority-donate-try) end
+EOF
+pass;
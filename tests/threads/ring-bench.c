@@ -0,0 +1,186 @@
+/* Moves 1 MB of "serial" traffic in 16-byte bursts, as a UART
+   FIFO would deliver it, through an intq and through a ring, and
+   reports the cost per byte.  The producer side stands in for an
+   interrupt handler and adds one byte at a time; the consumer
+   side is a thread.  Also streams sequence numbers between two
+   threads through a small ring, so that both sides are preempted
+   mid-transfer and the ring wraps many times, and checks that
+   every element arrives once and in order. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <ring.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/intq.h"
+
+#define BYTE_CNT (1024 * 1024)
+#define BURST 16
+
+static uint8_t ring_buf[64];
+
+static void
+report (const char *how, uint64_t cycles)
+{
+    msg ("%s: %" PRIu64 " cycles/byte", how, cycles / BYTE_CNT);
+}
+
+static void
+bench_intq (void)
+{
+    static struct intq q;
+    enum intr_level old_level;
+    uint64_t start;
+    unsigned sum = 0;
+    int i, j;
+
+    intq_init (&q);
+    start = rdtsc ();
+    for (i = 0; i < BYTE_CNT; i += BURST)
+        {
+            old_level = intr_disable ();
+            for (j = 0; j < BURST; j++)
+                intq_putc (&q, i + j);
+            intr_set_level (old_level);
+
+            /* Readers such as input_getc() turn interrupts off
+               around each byte. */
+            for (j = 0; j < BURST; j++)
+                {
+                    old_level = intr_disable ();
+                    sum += intq_getc (&q);
+                    intr_set_level (old_level);
+                }
+        }
+    report ("intq", rdtsc () - start);
+    if (sum != (unsigned) BYTE_CNT / 256 * (255 * 256 / 2))
+        fail ("intq corrupted the data");
+}
+
+static void
+bench_ring (bool bulk)
+{
+    struct ring r;
+    uint64_t start;
+    unsigned sum = 0;
+    int i, j;
+
+    ring_init (&r, ring_buf, sizeof ring_buf, 1);
+    start = rdtsc ();
+    for (i = 0; i < BYTE_CNT; i += BURST)
+        {
+            for (j = 0; j < BURST; j++)
+                {
+                    uint8_t byte = i + j;
+                    ring_enqueue (&r, &byte, 1);
+                }
+
+            if (bulk)
+                {
+                    uint8_t bytes[BURST];
+                    size_t cnt = ring_dequeue (&r, bytes, BURST);
+                    for (j = 0; j < (int) cnt; j++)
+                        sum += bytes[j];
+                }
+            else
+                for (j = 0; j < BURST; j++)
+                    {
+                        uint8_t byte;
+                        ring_dequeue (&r, &byte, 1);
+                        sum += byte;
+                    }
+        }
+    report (bulk ? "ring, bulk dequeue" : "ring, byte dequeue",
+            rdtsc () - start);
+    if (sum != (unsigned) BYTE_CNT / 256 * (255 * 256 / 2))
+        fail ("ring corrupted the data");
+}
+
+/* Two-thread stream.  Elements are 12 bytes, so that copies
+   straddle the end of the buffer at odd offsets. */
+#define SEQ_CNT 200000
+#define SEQ_BATCH 5
+
+struct seq
+{
+    uint32_t n;
+    uint32_t check;
+    uint32_t pad;
+};
+
+static struct ring seq_ring;
+static struct seq seq_buf[16];
+static struct semaphore done_sema;
+
+static void
+producer (void *aux UNUSED)
+{
+    uint32_t n = 0;
+
+    while (n < SEQ_CNT)
+        {
+            struct seq batch[SEQ_BATCH];
+            size_t cnt = SEQ_CNT - n < SEQ_BATCH ? SEQ_CNT - n : SEQ_BATCH;
+            size_t i, done;
+
+            for (i = 0; i < cnt; i++)
+                {
+                    batch[i].n = n + i;
+                    batch[i].check = ~(n + i);
+                }
+            done = ring_enqueue (&seq_ring, batch, cnt);
+            n += done;
+            if (done == 0)
+                thread_yield ();
+        }
+    sema_up (&done_sema);
+}
+
+static void
+consumer (void *aux UNUSED)
+{
+    uint32_t n = 0;
+
+    while (n < SEQ_CNT)
+        {
+            struct seq batch[SEQ_BATCH + 2];
+            size_t cnt = ring_dequeue (&seq_ring, batch, SEQ_BATCH + 2);
+            size_t i;
+
+            for (i = 0; i < cnt; i++, n++)
+                if (batch[i].n != n || batch[i].check != ~n)
+                    fail ("expected element %u, got %u", n, batch[i].n);
+            if (cnt == 0)
+                thread_yield ();
+        }
+    sema_up (&done_sema);
+}
+
+static void
+check_stream (void)
+{
+    ring_init (&seq_ring, seq_buf, 16, sizeof *seq_buf);
+    sema_init (&done_sema, 0);
+    thread_create ("producer", PRI_DEFAULT, producer, NULL);
+    thread_create ("consumer", PRI_DEFAULT, consumer, NULL);
+    sema_down (&done_sema);
+    sema_down (&done_sema);
+    if (!ring_empty (&seq_ring))
+        fail ("ring not empty after the stream");
+}
+
+void
+test_ring_bench (void)
+{
+    ASSERT (!thread_mlfqs);
+
+    bench_intq ();
+    bench_ring (false);
+    bench_ring (true);
+    check_stream ();
+    pass ();
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that every queue
+# reported a result and the test passed.
+#
+# (ring-bench) intq: 160 cycles/byte
+# (ring-bench) ring, byte dequeue: 70 cycles/byte
+# (ring-bench) ring, bulk dequeue: 40 cycles/byte
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/: \d+ cycles\/byte/, @output);
+fail "Expected 3 results but found " . scalar (@results) . ".\n"
+  if @results != 3;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(ring-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,182 @@
+/* Measures how read throughput scales with the number of reader
+   threads, for a plain lock and for a readers-writer lock.  Each
+   reader repeatedly takes the lock and sleeps for one tick while
+   holding it, standing in for a read that waits on I/O.  With a
+   plain lock only one reader makes progress per tick; with an
+   rwlock all of them do.  Also checks writer preference, the
+   priority order of hand-offs, and upgrade/downgrade. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define RUN_TICKS 50
+#define READER_MAX 8
+
+static struct lock lock;
+static struct rwlock rwlock;
+static struct semaphore done_sema;
+static bool use_rwlock;
+static int64_t end_tick;
+static int reads[READER_MAX];
+
+static void
+reader (void *aux)
+{
+    int *cnt = aux;
+
+    while (timer_ticks () < end_tick)
+        {
+            if (use_rwlock)
+                rwlock_acquire_read (&rwlock);
+            else
+                lock_acquire (&lock);
+            timer_sleep (1);
+            if (use_rwlock)
+                rwlock_release_read (&rwlock);
+            else
+                lock_release (&lock);
+            (*cnt)++;
+        }
+    sema_up (&done_sema);
+}
+
+/* Runs READER_CNT readers for RUN_TICKS ticks and returns the
+   total number of reads they completed. */
+static int
+run_readers (int reader_cnt)
+{
+    int total = 0;
+    int i;
+
+    sema_init (&done_sema, 0);
+    timer_sleep (1);
+    end_tick = timer_ticks () + RUN_TICKS;
+    for (i = 0; i < reader_cnt; i++)
+        {
+            char name[16];
+
+            reads[i] = 0;
+            snprintf (name, sizeof name, "reader %d", i);
+            if (thread_create (name, PRI_DEFAULT, reader, &reads[i]) == TID_ERROR)
+                fail ("thread_create() failed for %s", name);
+        }
+    for (i = 0; i < reader_cnt; i++)
+        sema_down (&done_sema);
+    for (i = 0; i < reader_cnt; i++)
+        total += reads[i];
+    return total;
+}
+
+static void
+bench_readers (void)
+{
+    int reader_cnt;
+
+    lock_init (&lock);
+    rwlock_init (&rwlock);
+    for (reader_cnt = 1; reader_cnt <= READER_MAX; reader_cnt *= 2)
+        {
+            int lock_reads, rwlock_reads;
+
+            use_rwlock = false;
+            lock_reads = run_readers (reader_cnt);
+            use_rwlock = true;
+            rwlock_reads = run_readers (reader_cnt);
+            msg ("%d readers: lock %d reads, rwlock %d reads in %d ticks",
+                 reader_cnt, lock_reads, rwlock_reads, RUN_TICKS);
+            if (reader_cnt > 1 && rwlock_reads <= lock_reads)
+                fail ("rwlock did not let %d readers run in parallel", reader_cnt);
+        }
+}
+
+/* Hand-off order. */
+static char order[4];
+static int order_cnt;
+
+static void
+order_reader (void *aux)
+{
+    rwlock_acquire_read (&rwlock);
+    order[order_cnt++] = *(const char *) aux;
+    rwlock_release_read (&rwlock);
+}
+
+static void
+order_writer (void *aux)
+{
+    rwlock_acquire_write (&rwlock);
+    order[order_cnt++] = *(const char *) aux;
+    rwlock_release_write (&rwlock);
+}
+
+/* Upgrades a read lock while the main thread still holds one. */
+static void
+upgrader (void *aux UNUSED)
+{
+    rwlock_acquire_read (&rwlock);
+    if (!rwlock_upgrade (&rwlock))
+        fail ("upgrader: rwlock_upgrade() failed");
+    order[order_cnt++] = 'U';
+    rwlock_release_write (&rwlock);
+}
+
+static void
+check_semantics (void)
+{
+    rwlock_init (&rwlock);
+
+    /* A waiting writer keeps new readers out, but a waiting reader
+       of higher priority than the writer is still served first. */
+    order_cnt = 0;
+    rwlock_acquire_read (&rwlock);
+    thread_create ("writer", PRI_DEFAULT + 1, order_writer, "W");
+    if (rwlock_try_acquire_read (&rwlock))
+        fail ("reader admitted while a writer was waiting");
+    thread_create ("reader", PRI_DEFAULT + 2, order_reader, "R");
+    if (order_cnt != 0)
+        fail ("lock handed off while still held for reading");
+    rwlock_release_read (&rwlock);
+    if (order_cnt != 2 || order[0] != 'R' || order[1] != 'W')
+        fail ("waiters were not served in priority order");
+
+    /* A sole reader upgrades and downgrades without waiting. */
+    rwlock_acquire_read (&rwlock);
+    if (!rwlock_upgrade (&rwlock) || !rwlock_held_by_current_thread (&rwlock))
+        fail ("sole reader could not upgrade");
+    if (rwlock_try_acquire_read (&rwlock) || rwlock_try_acquire_write (&rwlock))
+        fail ("rwlock held for writing admitted another holder");
+    rwlock_downgrade (&rwlock);
+    if (!rwlock_try_acquire_read (&rwlock))
+        fail ("rwlock_downgrade() did not leave a read lock");
+    rwlock_release_read (&rwlock);
+    rwlock_release_read (&rwlock);
+
+    /* An upgrade waits for the other readers, and beats waiting
+       writers to the lock. */
+    order_cnt = 0;
+    rwlock_acquire_read (&rwlock);
+    thread_create ("upgrader", PRI_DEFAULT + 1, upgrader, NULL);
+    thread_create ("writer", PRI_DEFAULT + 2, order_writer, "W");
+    if (rwlock_upgrade (&rwlock))
+        fail ("second upgrade did not fail");
+    rwlock_release_read (&rwlock);
+    if (order_cnt != 2 || order[0] != 'U' || order[1] != 'W')
+        fail ("upgrade did not take precedence over a waiting writer");
+    if (!rwlock_try_acquire_write (&rwlock))
+        fail ("rwlock not free after all holders released it");
+    rwlock_release_write (&rwlock);
+}
+
+void
+test_rwlock_bench (void)
+{
+    ASSERT (!thread_mlfqs);
+
+    check_semantics ();
+    bench_readers ();
+    pass ();
+}
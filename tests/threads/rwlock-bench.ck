@@ -0,0 +1,27 @@
+# -*- perl -*-
+
+# Read counts vary from run to run, so only check that every
+# reader count reported a result and the test passed.
+#
+# (rwlock-bench) 1 readers: lock 50 reads, rwlock 50 reads in 50 ticks
+# (rwlock-bench) 2 readers: lock 50 reads, rwlock 100 reads in 50 ticks
+# (rwlock-bench) 4 readers: lock 50 reads, rwlock 200 reads in 50 ticks
+# (rwlock-bench) 8 readers: lock 50 reads, rwlock 400 reads in 50 ticks
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/\d+ readers: lock \d+ reads, rwlock \d+ reads in \d+ ticks/,
+                      @output);
+fail "Expected 4 results but found " . scalar (@results) . ".\n"
+  if @results != 4;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(rwlock-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,69 @@
+/* Measures the cost of schedule() as the number of ready threads
+   grows.  The main thread runs at PRI_MAX and repeatedly yields
+   while N workers at random priorities at or below PRI_DEFAULT
+   sit in the ready queues, so every yield walks the full
+   next_thread_to_run() path with a populated run queue. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <random.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define YIELD_CNT 2000
+
+static thread_func worker;
+static struct semaphore done_sema;
+
+static const int thread_counts[] = { 0, 16, 64, 160 };
+
+void
+test_sched_bench (void)
+{
+    size_t i;
+
+    ASSERT (!thread_mlfqs);
+
+    sema_init (&done_sema, 0);
+    thread_set_priority (PRI_MAX);
+
+    for (i = 0; i < sizeof thread_counts / sizeof *thread_counts; i++)
+        {
+            int cnt = thread_counts[i];
+            uint64_t start, cycles;
+            int j;
+
+            for (j = 0; j < cnt; j++)
+                {
+                    char name[16];
+                    int priority = random_ulong () % (PRI_DEFAULT + 1);
+
+                    snprintf (name, sizeof name, "worker %d", j);
+                    thread_create (name, priority, worker, NULL);
+                }
+
+            start = rdtsc ();
+            for (j = 0; j < YIELD_CNT; j++)
+                thread_yield ();
+            cycles = rdtsc () - start;
+
+            msg ("%d ready threads: %" PRIu64 " cycles per schedule()",
+                 cnt, cycles / YIELD_CNT);
+
+            /* Block so the workers can run and exit. */
+            for (j = 0; j < cnt; j++)
+                sema_down (&done_sema);
+        }
+
+    thread_set_priority (PRI_DEFAULT);
+    pass ();
+}
+
+static void
+worker (void *aux UNUSED)
+{
+    sema_up (&done_sema);
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+
+# Benchmark output varies from run to run, so only check that
+# every configuration reported a result and the test passed.
+#
+# (sched-bench) 0 ready threads: 412 cycles per schedule()
+# (sched-bench) 16 ready threads: 430 cycles per schedule()
+# ...
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/\d+ ready threads: \d+ cycles per schedule\(\)/, @output);
+fail "Expected 4 benchmark results but found " . scalar (@results) . ".\n"
+  if @results != 4;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(sched-bench\) PASS/, @output);
+
+pass;
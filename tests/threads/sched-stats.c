@@ -0,0 +1,76 @@
+/* Exercises the scheduler statistics printed by the "schedstats"
+   action.  One thread yields repeatedly, one sleeps, and one
+   blocks on a semaphore, so every column of the per-thread table
+   and several latency buckets get nonzero counts.  The checks
+   are on the table printed at shutdown. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define ROUNDS 50
+
+static thread_func yielder, sleeper, waiter;
+static struct semaphore wait_sema;
+static struct semaphore done_sema;
+
+void
+test_sched_stats (void)
+{
+    int i;
+
+    ASSERT (thread_report_sched);
+
+    sema_init (&wait_sema, 0);
+    sema_init (&done_sema, 0);
+
+    thread_create ("yielder", PRI_DEFAULT, yielder, NULL);
+    thread_create ("sleeper", PRI_DEFAULT, sleeper, NULL);
+    thread_create ("waiter", PRI_DEFAULT, waiter, NULL);
+
+    for (i = 0; i < ROUNDS; i++)
+        {
+            timer_sleep (1);
+            sema_up (&wait_sema);
+        }
+    for (i = 0; i < 3; i++)
+        sema_down (&done_sema);
+
+    /* Give the threads time to finish exiting. */
+    timer_sleep (2);
+
+    msg ("3 threads done");
+}
+
+static void
+yielder (void *aux UNUSED)
+{
+    int i;
+
+    for (i = 0; i < ROUNDS; i++)
+        thread_yield ();
+    sema_up (&done_sema);
+}
+
+static void
+sleeper (void *aux UNUSED)
+{
+    int i;
+
+    for (i = 0; i < ROUNDS; i++)
+        timer_sleep (1);
+    sema_up (&done_sema);
+}
+
+static void
+waiter (void *aux UNUSED)
+{
+    int i;
+
+    for (i = 0; i < ROUNDS; i++)
+        sema_down (&wait_sema);
+    sema_up (&done_sema);
+}
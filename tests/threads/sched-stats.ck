@@ -0,0 +1,48 @@
+# -*- perl -*-
+
+# The statistics printed at shutdown look like this, with times
+# in thousands of TSC cycles:
+#
+# Scheduler: times in thousands of TSC cycles
+#   thread                    run        ready      blocked      vol    invol
+#   1 main                 412031          212       190332       66        0
+#   2 idle                 180251            0            0       95        0
+#   3 exited                 2810          451        89702      154       52
+# Ready latency in TSC cycles:
+#   >=                 2048       12 ****
+#   >=                 4096      120 ****************************************
+#   >=                 8192       66 **********************
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+fail "Test did not finish.\n"
+  if !grep (/\(sched-stats\) 3 threads done/, @output);
+
+my ($line) = grep (/^Scheduler: /, @output);
+fail "No scheduler statistics at shutdown.\n" if !defined $line;
+
+my ($main) = grep (/^\s+\d+ main\s+\d+\s+\d+\s+\d+\s+\d+\s+\d+$/, @output);
+fail "No statistics for the main thread.\n" if !defined $main;
+
+my ($exited) = grep (/^\s+3 exited\s/, @output);
+fail "Expected statistics for 3 exited threads.\n" if !defined $exited;
+my (undef, undef, $run, $ready, $blocked, $vol, $invol)
+  = split (' ', $exited);
+fail "Exited threads should have both voluntary and involuntary "
+  . "switches: $exited\n"
+  if $vol == 0 || $invol == 0;
+
+my (@buckets) = grep (/^\s+>=\s+\d+\s+\d+ \*+$/, @output);
+fail "Ready latency histogram is empty.\n" if !@buckets;
+my ($switches) = 0;
+$switches += (split (' ', $_))[2] foreach @buckets;
+fail "Ready latency histogram has only $switches entries.\n"
+  if $switches < 150;
+
+pass;
@@ -0,0 +1,57 @@
+/* Exercises work stealing between run queues.  Run with "-rq=2",
+   which spreads new threads over two run queues although only
+   the boot processor runs.  Four CPU-bound threads alternate
+   between the queues; the CPU runs the two on its own queue
+   first and must then take the other two from the second queue
+   one at a time, as an idle processor would.  The checks are on
+   the order in which the threads finish and on the per-queue
+   steal counts printed at shutdown by "schedstats". */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 4
+#define WORK_TICKS 12
+
+static thread_func worker;
+static struct semaphore done_sema;
+
+void
+test_sched_steal (void)
+{
+    static int ids[THREAD_CNT];
+    int i;
+
+    ASSERT (!thread_mlfqs);
+
+    sema_init (&done_sema, 0);
+    for (i = 0; i < THREAD_CNT; i++)
+        {
+            char name[16];
+
+            ids[i] = i;
+            snprintf (name, sizeof name, "worker %d", i);
+            thread_create (name, PRI_DEFAULT, worker, &ids[i]);
+        }
+    for (i = 0; i < THREAD_CNT; i++)
+        sema_down (&done_sema);
+    msg ("%d workers done", THREAD_CNT);
+}
+
+/* Spins for WORK_TICKS timer ticks, so that the thread uses up
+   several time slices. */
+static void
+worker (void *id_)
+{
+    int id = *(int *) id_;
+    int64_t start = timer_ticks ();
+
+    while (timer_elapsed (start) < WORK_TICKS)
+        continue;
+    msg ("worker %d done", id);
+    sema_up (&done_sema);
+}
@@ -0,0 +1,44 @@
+# -*- perl -*-
+
+# Workers 0 and 2 go to run queue 0 and workers 1 and 3 to run
+# queue 1.  Queue 1's workers only run once queue 0 is empty, so
+# they finish last, and queue 0 steals each of them:
+#
+# (sched-steal) worker 0 done
+# (sched-steal) worker 2 done
+# (sched-steal) worker 1 done
+# (sched-steal) worker 3 done
+# (sched-steal) 4 workers done
+# ...
+# Run queue 0: 0 ready, 2 stolen
+# Run queue 1: 0 ready, 0 stolen
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+fail "Test did not finish.\n"
+  if !grep (/\(sched-steal\) 4 workers done/, @output);
+
+my (@done) = map (/\(sched-steal\) worker (\d) done/ ? $1 : (), @output);
+fail "Expected 4 workers to finish but " . scalar (@done) . " did.\n"
+  if @done != 4;
+fail "Run queue 1's workers finished before run queue 0's: @done.\n"
+  if join (' ', sort @done[0..1]) ne '0 2' || join (' ', sort @done[2..3]) ne '1 3';
+
+my (%stolen);
+foreach (@output) {
+    $stolen{$1} = $2 if /^Run queue (\d+): \d+ ready, (\d+) stolen$/;
+}
+fail "No statistics for 2 run queues.\n"
+  if !defined $stolen{0} || !defined $stolen{1};
+fail "Run queue 0 stole $stolen{0} threads, expected 2.\n"
+  if $stolen{0} != 2;
+fail "Run queue 1 stole $stolen{1} threads, expected 0.\n"
+  if $stolen{1} != 0;
+
+pass;
@@ -0,0 +1,205 @@
+/* Parks 200 threads, of 16 different priorities, on a semaphore
+   and then on a condition variable, and reports the cost of each
+   sema_up() and cond_signal() that wakes one of them.  Then
+   checks that waiters wake in priority order, FIFO within a
+   priority, including a waiter whose priority is raised by
+   donation while it is blocked. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define WAITER_CNT 200
+
+static struct semaphore sema;
+static struct lock lock;
+static struct condition cond;
+static struct semaphore done_sema;
+static int parked;
+
+static void
+report (const char *how, uint64_t cycles)
+{
+    msg ("%s: %d waiters, %" PRIu64 " cycles/wakeup", how, WAITER_CNT,
+         cycles / WAITER_CNT);
+}
+
+/* Creates WAITER_CNT threads below our priority, each running
+   FUNC, and sleeps until all of them are waiting. */
+static void
+park_waiters (thread_func *func)
+{
+    int i;
+
+    parked = 0;
+    for (i = 0; i < WAITER_CNT; i++)
+        if (thread_create ("waiter", PRI_MIN + i % 16, func, NULL) == TID_ERROR)
+            fail ("thread_create() failed for waiter %d", i);
+    for (;;)
+        {
+            int cnt;
+
+            lock_acquire (&lock);
+            cnt = parked;
+            lock_release (&lock);
+            if (cnt == WAITER_CNT)
+                break;
+            timer_sleep (1);
+        }
+}
+
+static void
+sema_waiter (void *aux UNUSED)
+{
+    enum intr_level old_level;
+
+    /* Count ourselves only once we are about to block. */
+    old_level = intr_disable ();
+    parked++;
+    sema_down (&sema);
+    intr_set_level (old_level);
+    sema_up (&done_sema);
+}
+
+static void
+cond_waiter (void *aux UNUSED)
+{
+    lock_acquire (&lock);
+    parked++;
+    cond_wait (&cond, &lock);
+    lock_release (&lock);
+    sema_up (&done_sema);
+}
+
+static void
+bench_sema (void)
+{
+    uint64_t start;
+    int i;
+
+    park_waiters (sema_waiter);
+    start = rdtsc ();
+    for (i = 0; i < WAITER_CNT; i++)
+        sema_up (&sema);
+    report ("sema_up", rdtsc () - start);
+    for (i = 0; i < WAITER_CNT; i++)
+        sema_down (&done_sema);
+}
+
+static void
+bench_cond (void)
+{
+    uint64_t start;
+    int i;
+
+    park_waiters (cond_waiter);
+    lock_acquire (&lock);
+    start = rdtsc ();
+    for (i = 0; i < WAITER_CNT; i++)
+        cond_signal (&cond, &lock);
+    report ("cond_signal", rdtsc () - start);
+    lock_release (&lock);
+    for (i = 0; i < WAITER_CNT; i++)
+        sema_down (&done_sema);
+}
+
+/* Wakeup order.  Waiters run above our priority, so each
+   sema_up() switches straight to the thread it woke. */
+struct waiter
+{
+    int id;
+    int priority;
+};
+
+static struct waiter waiters[WAITER_CNT + 1];
+static int order[WAITER_CNT + 1];
+static int order_cnt;
+
+static void
+order_waiter (void *w_)
+{
+    struct waiter *w = w_;
+
+    sema_down (&sema);
+    order[order_cnt++] = w->id;
+}
+
+/* Blocks on SEMA while holding LOCK, so that a thread which
+   wants LOCK donates to us while we wait. */
+static void
+donee (void *w_)
+{
+    struct waiter *w = w_;
+
+    lock_acquire (&lock);
+    sema_down (&sema);
+    order[order_cnt++] = w->id;
+    lock_release (&lock);
+}
+
+static void
+donor (void *aux UNUSED)
+{
+    lock_acquire (&lock);
+    lock_release (&lock);
+}
+
+static void
+check_order (void)
+{
+    struct waiter *donee_w = &waiters[WAITER_CNT];
+    int i;
+
+    order_cnt = 0;
+    for (i = 0; i < WAITER_CNT; i++)
+        {
+            waiters[i].id = i;
+            waiters[i].priority = PRI_DEFAULT + 1 + i % 8;
+            thread_create ("waiter", waiters[i].priority, order_waiter,
+                           &waiters[i]);
+        }
+    donee_w->id = WAITER_CNT;
+    donee_w->priority = PRI_DEFAULT + 1;
+    thread_create ("donee", donee_w->priority, donee, donee_w);
+    thread_create ("donor", PRI_MAX, donor, NULL);
+
+    for (i = 0; i <= WAITER_CNT; i++)
+        sema_up (&sema);
+
+    if (order_cnt != WAITER_CNT + 1)
+        fail ("%d of %d waiters woke up", order_cnt, WAITER_CNT + 1);
+    if (order[0] != donee_w->id)
+        fail ("waiter with donated priority did not wake first");
+    for (i = 2; i <= WAITER_CNT; i++)
+        {
+            const struct waiter *a = &waiters[order[i - 1]];
+            const struct waiter *b = &waiters[order[i]];
+
+            if (a->priority < b->priority
+                || (a->priority == b->priority && a->id > b->id))
+                fail ("waiter %d (priority %d) woke before waiter %d "
+                      "(priority %d)", a->id, a->priority, b->id, b->priority);
+        }
+}
+
+void
+test_sema_wake_bench (void)
+{
+    ASSERT (!thread_mlfqs);
+
+    sema_init (&sema, 0);
+    sema_init (&done_sema, 0);
+    lock_init (&lock);
+    cond_init (&cond);
+
+    bench_sema ();
+    bench_cond ();
+    check_order ();
+    pass ();
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that both
+# primitives reported a result and the test passed.
+#
+# (sema-wake-bench) sema_up: 200 waiters, 2100 cycles/wakeup
+# (sema-wake-bench) cond_signal: 200 waiters, 2400 cycles/wakeup
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/: 200 waiters, \d+ cycles\/wakeup/, @output);
+fail "Expected 2 results but found " . scalar (@results) . ".\n"
+  if @results != 2;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(sema-wake-bench\) PASS/, @output);
+
+pass;
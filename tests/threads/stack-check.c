@@ -0,0 +1,57 @@
+/* Exercises the stack high-water marks reported by the
+   "-stack-check" option.  One thread recurses through about 2 kB
+   of stack before exiting and another exits almost at once; the
+   checks are on the marks the kernel prints as each exits. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define FRAME_SIZE 128
+#define DEPTH 16
+
+static thread_func deep, shallow;
+static struct semaphore done_sema;
+
+void
+test_stack_check (void)
+{
+    ASSERT (thread_stack_check);
+
+    sema_init (&done_sema, 0);
+    thread_create ("deep", PRI_DEFAULT, deep, NULL);
+    sema_down (&done_sema);
+    thread_create ("shallow", PRI_DEFAULT, shallow, NULL);
+    sema_down (&done_sema);
+    msg ("2 threads done");
+}
+
+/* Uses FRAME_SIZE bytes of stack per level for LEVEL more levels
+   and returns a value that depends on all of them, so that the
+   compiler cannot drop the buffers. */
+static int
+recurse (int level)
+{
+    volatile char buf[FRAME_SIZE];
+    int sum;
+
+    memset ((char *) buf, level, sizeof buf);
+    sum = level > 0 ? recurse (level - 1) : 0;
+    return sum + buf[level % FRAME_SIZE];
+}
+
+static void
+deep (void *aux UNUSED)
+{
+    msg ("deep: %d", recurse (DEPTH));
+    sema_up (&done_sema);
+}
+
+static void
+shallow (void *aux UNUSED)
+{
+    sema_up (&done_sema);
+}
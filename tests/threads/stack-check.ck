@@ -0,0 +1,37 @@
+# -*- perl -*-
+
+# Each thread prints its stack high-water mark as it exits:
+#
+# deep: stack high-water mark 2444 of 3608 bytes
+# shallow: stack high-water mark 164 of 3608 bytes
+#
+# The exact numbers depend on the compiler, so only check that
+# the deep thread used at least the 2 kB it recursed through and
+# the shallow one much less.
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+fail "Test did not finish.\n"
+  if !grep (/\(stack-check\) 2 threads done/, @output);
+
+my (%mark);
+foreach (@output) {
+    $mark{$1} = [$2, $3] if /^(\w+): stack high-water mark (\d+) of (\d+) bytes$/;
+}
+foreach my $name ('deep', 'shallow') {
+    fail "No stack high-water mark for $name.\n" if !defined $mark{$name};
+    my ($used, $size) = @{$mark{$name}};
+    fail "$name used $used of $size bytes.\n" if $used == 0 || $used > $size;
+}
+fail "deep thread used only $mark{deep}[0] bytes of stack.\n"
+  if $mark{deep}[0] < 2048;
+fail "shallow thread used $mark{shallow}[0] bytes of stack.\n"
+  if $mark{shallow}[0] >= 1024;
+
+pass;
@@ -0,0 +1,53 @@
+/* Checks that "-stack-check" catches a kernel stack overflow on
+   the spot.  A thread recurses through far more stack than its
+   page holds.  Its first write past the bottom of the stack lands
+   on the magic number at the top of its struct thread, and the
+   debug-register watchpoint on it must panic the kernel, naming
+   the thread, before anything else runs. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+#define FRAME_SIZE 128
+#define DEPTH (2 * PGSIZE / FRAME_SIZE)
+
+static thread_func overflow;
+static struct semaphore done_sema;
+
+void
+test_stack_overflow (void)
+{
+    ASSERT (thread_stack_check);
+
+    sema_init (&done_sema, 0);
+    thread_create ("overflow", PRI_DEFAULT, overflow, NULL);
+    sema_down (&done_sema);
+    fail ("stack overflow was not caught");
+}
+
+/* Uses FRAME_SIZE bytes of stack per level for LEVEL more levels
+   and returns a value that depends on all of them, so that the
+   compiler cannot drop the buffers or the recursion. */
+static int
+recurse (int level)
+{
+    volatile char buf[FRAME_SIZE];
+    int sum;
+
+    memset ((char *) buf, level, sizeof buf);
+    sum = level > 0 ? recurse (level - 1) : 0;
+    return sum + buf[level % FRAME_SIZE];
+}
+
+static void
+overflow (void *aux UNUSED)
+{
+    msg ("recursing through %d bytes of stack", DEPTH * FRAME_SIZE);
+    msg ("overflow: %d", recurse (DEPTH));
+    sema_up (&done_sema);
+}
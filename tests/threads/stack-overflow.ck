@@ -0,0 +1,26 @@
+# -*- perl -*-
+
+# The overflowing write must panic the kernel at once:
+#
+# (stack-overflow) recursing through 8192 bytes of stack
+# Kernel PANIC at ../../threads/thread.c:1707 in stack_watch_fault(): kernel stack overflow in thread "overflow" at 0xc0021234
+#
+# so the test never gets to report a result of its own.
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+fail "Test did not start.\n"
+  if !grep (/\(stack-overflow\) recursing through \d+ bytes of stack/, @output);
+fail "Recursion returned instead of overflowing.\n"
+  if grep (/\(stack-overflow\) overflow: /, @output);
+fail "Stack overflow was not caught.\n"
+  if !grep (/Kernel PANIC .*: kernel stack overflow in thread "overflow"/,
+            @output);
+check_for_triple_fault ("run", @output);
+
+pass;
@@ -0,0 +1,80 @@
+/* Checks that stride scheduling divides the CPU in proportion to
+   tickets.  Four threads with 100, 200, 300, and 400 tickets spin
+   for 10,000 ticks, counting the ticks in which they run.  They
+   have very different priorities, which stride scheduling should
+   ignore, so the lowest-priority thread must not starve.
+
+   The tick counts should be close to 1,000, 2,000, 3,000, and
+   4,000.  stride-fair.ck checks how far each share deviates. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 4
+#define SPIN_TICKS 10000
+
+struct thread_info
+  {
+    int64_t start_time;
+    int tickets;
+    int tick_count;
+  };
+
+static thread_func load_thread;
+
+void
+test_stride_fair (void)
+{
+    static const int priorities[THREAD_CNT] = { PRI_MAX, PRI_DEFAULT, 10,
+                                                PRI_MIN };
+    struct thread_info info[THREAD_CNT];
+    int64_t start_time;
+    int i;
+
+    ASSERT (thread_stride);
+
+    start_time = timer_ticks ();
+    for (i = 0; i < THREAD_CNT; i++)
+        {
+            struct thread_info *ti = &info[i];
+            char name[16];
+
+            ti->start_time = start_time;
+            ti->tickets = 100 * (i + 1);
+            ti->tick_count = 0;
+
+            snprintf (name, sizeof name, "load %d", i);
+            thread_create (name, priorities[i], load_thread, ti);
+        }
+
+    msg ("Sleeping %d ticks to let threads run, please wait...", SPIN_TICKS);
+    timer_sleep (TIMER_FREQ + SPIN_TICKS + TIMER_FREQ);
+
+    for (i = 0; i < THREAD_CNT; i++)
+        msg ("Thread %d with %d tickets received %d ticks.",
+             i, info[i].tickets, info[i].tick_count);
+}
+
+static void
+load_thread (void *ti_)
+{
+    struct thread_info *ti = ti_;
+    int64_t sleep_time = TIMER_FREQ;
+    int64_t spin_time = sleep_time + SPIN_TICKS;
+    int64_t last_time = 0;
+
+    thread_set_tickets (ti->tickets);
+    timer_sleep (sleep_time - timer_elapsed (ti->start_time));
+    while (timer_elapsed (ti->start_time) < spin_time)
+        {
+            int64_t cur_time = timer_ticks ();
+            if (cur_time != last_time)
+                ti->tick_count++;
+            last_time = cur_time;
+        }
+}
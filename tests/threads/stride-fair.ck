@@ -0,0 +1,35 @@
+# -*- perl -*-
+
+# Each thread should receive ticks in proportion to its tickets.
+# A thread's share may deviate from the ideal by at most 0.5% of
+# the 10,000 ticks, that is, 50 ticks.
+
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::mlfqs;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my (@actual, @tickets);
+local ($_);
+foreach (@output) {
+    my ($id, $tickets, $count)
+      = /Thread (\d+) with (\d+) tickets received (\d+) ticks\./ or next;
+    $actual[$id] = $count;
+    $tickets[$id] = $tickets;
+}
+fail "Expected 4 threads but found " . scalar (@tickets) . ".\n"
+  if @tickets != 4;
+
+my ($total_tickets) = 0;
+$total_tickets += $_ foreach @tickets;
+my (@expected) = map (10000 * $_ / $total_tickets, @tickets);
+
+mlfqs_compare ("thread", "%d", \@actual, \@expected, 50, [0, 3, 1],
+	       "Some tick counts deviated from the threads' shares "
+	       . "by more than 50 ticks.");
+pass;
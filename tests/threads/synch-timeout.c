@@ -0,0 +1,130 @@
+/* Checks sema_down_timeout(), lock_acquire_timeout() and
+   cond_wait_timeout(): each gives up once its timeout expires,
+   returns as soon as it is woken otherwise, and leaves no trace
+   in the queue it did not wake from.  A lock waiter that times
+   out also takes back the priority it donated. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HOLDER_PRI (PRI_DEFAULT - 10)
+
+static struct semaphore sema;
+static struct lock lock;
+static struct condition cond;
+static struct semaphore held_sema;
+static struct semaphore release_sema;
+static struct thread *holder;
+
+/* Sleeps 3 ticks, then ups SEMA. */
+static void
+sema_upper (void *aux UNUSED)
+{
+    timer_sleep (3);
+    sema_up (&sema);
+}
+
+/* Acquires LOCK, lets the main thread know, and holds LOCK until
+   the main thread ups RELEASE_SEMA. */
+static void
+lock_holder (void *aux UNUSED)
+{
+    lock_acquire (&lock);
+    holder = thread_current ();
+    sema_up (&held_sema);
+    sema_down (&release_sema);
+    lock_release (&lock);
+}
+
+/* Sleeps 3 ticks, then signals COND. */
+static void
+signaler (void *aux UNUSED)
+{
+    timer_sleep (3);
+    lock_acquire (&lock);
+    cond_signal (&cond, &lock);
+    lock_release (&lock);
+}
+
+static void
+check_sema (void)
+{
+    int64_t start;
+
+    sema_init (&sema, 0);
+    start = timer_ticks ();
+    if (sema_down_timeout (&sema, 5))
+        fail ("sema_down_timeout() succeeded on a zero semaphore");
+    if (timer_elapsed (start) < 5)
+        fail ("sema_down_timeout() gave up early");
+    msg ("sema: timed out");
+
+    sema_up (&sema);
+    if (!sema_try_down (&sema))
+        fail ("sema_up() after a timeout was lost");
+    msg ("sema: late sema_up not lost");
+
+    thread_create ("upper", PRI_DEFAULT + 1, sema_upper, NULL);
+    start = timer_ticks ();
+    if (!sema_down_timeout (&sema, 100))
+        fail ("sema_down_timeout() timed out despite sema_up()");
+    if (timer_elapsed (start) >= 100)
+        fail ("sema_down_timeout() returned late");
+    msg ("sema: woken before timeout");
+}
+
+static void
+check_lock (void)
+{
+    lock_init (&lock);
+    sema_init (&held_sema, 0);
+    sema_init (&release_sema, 0);
+    thread_create ("holder", HOLDER_PRI, lock_holder, NULL);
+    sema_down (&held_sema);
+
+    if (lock_acquire_timeout (&lock, 5))
+        fail ("lock_acquire_timeout() acquired a held lock");
+    if (holder->priority != HOLDER_PRI)
+        fail ("holder kept priority %d after the waiter timed out",
+              holder->priority);
+    msg ("lock: timed out, donation withdrawn");
+
+    sema_up (&release_sema);
+    if (!lock_acquire_timeout (&lock, 100))
+        fail ("lock_acquire_timeout() timed out despite release");
+    lock_release (&lock);
+    msg ("lock: acquired before timeout");
+}
+
+static void
+check_cond (void)
+{
+    cond_init (&cond);
+
+    lock_acquire (&lock);
+    if (cond_wait_timeout (&cond, &lock, 5))
+        fail ("cond_wait_timeout() reported a signal");
+    if (!lock_held_by_current_thread (&lock))
+        fail ("cond_wait_timeout() returned without the lock");
+    msg ("cond: timed out, lock held");
+
+    thread_create ("signaler", PRI_DEFAULT + 1, signaler, NULL);
+    if (!cond_wait_timeout (&cond, &lock, 100))
+        fail ("cond_wait_timeout() timed out despite cond_signal()");
+    lock_release (&lock);
+    msg ("cond: signaled before timeout");
+}
+
+void
+test_synch_timeout (void)
+{
+    ASSERT (!thread_mlfqs);
+
+    check_sema ();
+    check_lock ();
+    check_cond ();
+}
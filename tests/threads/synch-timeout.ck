@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(synch-timeout) begin
+(synch-timeout) sema: timed out
+(synch-timeout) sema: late sema_up not lost
+(synch-timeout) sema: woken before timeout
+(synch-timeout) lock: timed out, donation withdrawn
+(synch-timeout) lock: acquired before timeout
+(synch-timeout) cond: timed out, lock held
+(synch-timeout) cond: signaled before timeout
+(synch-timeout) end
+EOF
+pass;
@@ -17,7 +17,40 @@ static const struct test tests[] = {
     { "priority-aging", test_priority_aging },
     { "priority-sema", test_priority_sema },
     { "priority-condvar", test_priority_condvar },
+    { "priority-donate-multiple", test_priority_donate_multiple },
+    { "priority-donate-nest", test_priority_donate_nest },
     { "mlfqs-simplified", test_mlfqs_simplified },
+    { "mlfqs-load-60", test_mlfqs_load_60 },
+    { "mlfqs-fair-2", test_mlfqs_fair_2 },
+    { "mlfqs-fair-20", test_mlfqs_fair_20 },
+    { "mlfqs-nice-10", test_mlfqs_nice_10 },
+    { "priority-aging-stress", test_priority_aging_stress },
+    { "sched-bench", test_sched_bench },
+    { "alarm-wheel-bench", test_alarm_wheel_bench },
+    { "alarm-tickless", test_alarm_tickless },
+    { "alarm-hires-bench", test_alarm_hires_bench },
+    { "sched-stats", test_sched_stats },
+    { "workqueue-bench", test_workqueue_bench },
+    { "thread-cache-bench", test_thread_cache_bench },
+    { "edf-deadline", test_edf_deadline },
+    { "stride-fair", test_stride_fair },
+    { "rwlock-bench", test_rwlock_bench },
+    { "sema-wake-bench", test_sema_wake_bench },
+    { "malloc-lock-bench", test_malloc_lock_bench },
+    { "synch-timeout", test_synch_timeout },
+    { "ring-bench", test_ring_bench },
+    { "par-sort-bench", test_par_sort_bench },
+    { "futex-bench", test_futex_bench },
+    { "stack-check", test_stack_check },
+    { "palloc-bench", test_palloc_bench },
+    { "bitmap-diff", test_bitmap_diff },
+    { "bitmap-bench", test_bitmap_bench },
+    { "malloc-mag-bench", test_malloc_mag_bench },
+    { "alarm-cancel", test_alarm_cancel },
+    { "priority-donate-adaptive", test_priority_donate_adaptive },
+    { "priority-donate-try", test_priority_donate_try },
+    { "stack-overflow", test_stack_overflow },
+    { "sched-steal", test_sched_steal },
 };
 
 static const char *test_name;
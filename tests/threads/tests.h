@@ -12,7 +12,40 @@ extern test_func test_priority_preempt_timer;
 extern test_func test_priority_aging;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_priority_donate_multiple;
+extern test_func test_priority_donate_nest;
 extern test_func test_mlfqs_simplified;
+extern test_func test_mlfqs_load_60;
+extern test_func test_mlfqs_fair_2;
+extern test_func test_mlfqs_fair_20;
+extern test_func test_mlfqs_nice_10;
+extern test_func test_priority_aging_stress;
+extern test_func test_sched_bench;
+extern test_func test_alarm_wheel_bench;
+extern test_func test_alarm_tickless;
+extern test_func test_alarm_hires_bench;
+extern test_func test_sched_stats;
+extern test_func test_workqueue_bench;
+extern test_func test_thread_cache_bench;
+extern test_func test_edf_deadline;
+extern test_func test_stride_fair;
+extern test_func test_rwlock_bench;
+extern test_func test_sema_wake_bench;
+extern test_func test_malloc_lock_bench;
+extern test_func test_synch_timeout;
+extern test_func test_ring_bench;
+extern test_func test_par_sort_bench;
+extern test_func test_futex_bench;
+extern test_func test_stack_check;
+extern test_func test_palloc_bench;
+extern test_func test_bitmap_diff;
+extern test_func test_bitmap_bench;
+extern test_func test_malloc_mag_bench;
+extern test_func test_alarm_cancel;
+extern test_func test_priority_donate_adaptive;
+extern test_func test_priority_donate_try;
+extern test_func test_stack_overflow;
+extern test_func test_sched_steal;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
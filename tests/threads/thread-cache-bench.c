@@ -0,0 +1,100 @@
+/* Measures the cost of creating a thread that exits right away,
+   with the thread page cache disabled and at its default size.
+   Threads are created either one at a time, each exiting before
+   the next is created, or in bursts of BURST_SIZE that are all
+   alive at once, which overflows the default cache. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define THREAD_CNT 2000
+#define BURST_SIZE 16
+
+static struct semaphore start_sema;
+static struct semaphore done_sema;
+
+static void
+quick (void *aux UNUSED)
+{
+    sema_up (&done_sema);
+}
+
+static void
+blocked (void *aux UNUSED)
+{
+    sema_down (&start_sema);
+    sema_up (&done_sema);
+}
+
+/* Creates THREAD_CNT threads one at a time.  Each has a higher
+   priority than us, so it runs and exits, and its page is freed,
+   before we create the next. */
+static uint64_t
+one_at_a_time (void)
+{
+    uint64_t start = rdtsc ();
+    int i;
+
+    for (i = 0; i < THREAD_CNT; i++)
+        {
+            if (thread_create ("quick", PRI_DEFAULT + 1, quick, NULL)
+                == TID_ERROR)
+                fail ("thread_create() failed");
+            sema_down (&done_sema);
+        }
+    return (rdtsc () - start) / THREAD_CNT;
+}
+
+/* Creates THREAD_CNT threads in bursts of BURST_SIZE that all
+   block until the burst is complete, then lets them exit. */
+static uint64_t
+bursts (void)
+{
+    uint64_t start = rdtsc ();
+    int i, j;
+
+    for (i = 0; i < THREAD_CNT / BURST_SIZE; i++)
+        {
+            for (j = 0; j < BURST_SIZE; j++)
+                if (thread_create ("blocked", PRI_DEFAULT + 1, blocked, NULL)
+                    == TID_ERROR)
+                    fail ("thread_create() failed");
+            for (j = 0; j < BURST_SIZE; j++)
+                {
+                    sema_up (&start_sema);
+                    sema_down (&done_sema);
+                }
+        }
+    return (rdtsc () - start) / (THREAD_CNT / BURST_SIZE * BURST_SIZE);
+}
+
+void
+test_thread_cache_bench (void)
+{
+    size_t default_size = thread_get_page_cache_size ();
+    static const size_t sizes[] = { 0, THREAD_CACHE_DEFAULT };
+    size_t i;
+
+    sema_init (&start_sema, 0);
+    sema_init (&done_sema, 0);
+
+    for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+        {
+            uint64_t single, burst;
+
+            thread_set_page_cache_size (sizes[i]);
+            single = one_at_a_time ();
+            burst = bursts ();
+            msg ("cache size %zu: %" PRIu64 " cycles/thread one at a time, "
+                 "%" PRIu64 " cycles/thread in bursts of %d",
+                 sizes[i], single, burst, BURST_SIZE);
+        }
+
+    thread_set_page_cache_size (default_size);
+    pass ();
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that both cache
+# sizes reported a result and the test passed.
+#
+# (thread-cache-bench) cache size 0: 15200 cycles/thread one at a time, 16900 cycles/thread in bursts of 16
+# (thread-cache-bench) cache size 8: 9100 cycles/thread one at a time, 12800 cycles/thread in bursts of 16
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/cache size \d+: \d+ cycles\/thread one at a time, \d+ cycles\/thread in bursts of \d+/,
+		      @output);
+fail "Expected 2 results but found " . scalar (@results) . ".\n"
+  if @results != 2;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(thread-cache-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,142 @@
+/* Runs 10,000 short jobs three ways and reports the cost per
+   job: one thread_create() per job, a work queue whose workers
+   preempt the submitter and so run each job as soon as it is
+   submitted, and a work queue whose workers run at the
+   submitter's priority and so drain the queue in batches.  Also
+   checks that every job ran exactly once and that higher
+   priority jobs run first. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+#define JOB_CNT 10000
+#define WORKER_CNT 4
+
+static int job_runs[JOB_CNT];
+static struct semaphore done_sema;
+
+static void
+job (void *aux)
+{
+    int *runs = aux;
+    (*runs)++;
+}
+
+static void
+thread_job (void *aux)
+{
+    job (aux);
+    sema_up (&done_sema);
+}
+
+/* Checks that every job ran exactly once, then clears the
+   counts. */
+static void
+check_runs (const char *how)
+{
+    int i;
+
+    for (i = 0; i < JOB_CNT; i++)
+        {
+            if (job_runs[i] != 1)
+                fail ("%s: job %d ran %d times", how, i, job_runs[i]);
+            job_runs[i] = 0;
+        }
+}
+
+static void
+report (const char *how, uint64_t cycles)
+{
+    msg ("%s: %d jobs, %" PRIu64 " cycles/job", how, JOB_CNT,
+         cycles / JOB_CNT);
+}
+
+static void
+bench_thread_create (void)
+{
+    uint64_t start;
+    int i;
+
+    sema_init (&done_sema, 0);
+    start = rdtsc ();
+    for (i = 0; i < JOB_CNT; i++)
+        {
+            /* A higher priority lets each job finish, and its page be
+               freed, before the next one is created. */
+            if (thread_create ("job", PRI_DEFAULT + 1, thread_job, &job_runs[i])
+                == TID_ERROR)
+                fail ("thread_create() failed for job %d", i);
+            sema_down (&done_sema);
+        }
+    report ("thread_create", rdtsc () - start);
+    check_runs ("thread_create");
+}
+
+static void
+bench_workqueue (const char *how, int priority)
+{
+    struct workqueue wq;
+    uint64_t start;
+    int i;
+
+    if (!workqueue_init (&wq, "bench", WORKER_CNT, priority))
+        fail ("%s: workqueue_init() failed", how);
+
+    start = rdtsc ();
+    for (i = 0; i < JOB_CNT; i++)
+        if (!workqueue_submit (&wq, job, &job_runs[i]))
+            fail ("%s: workqueue_submit() failed for job %d", how, i);
+    workqueue_flush (&wq);
+    report (how, rdtsc () - start);
+
+    workqueue_destroy (&wq);
+    check_runs (how);
+}
+
+/* Priority ordering. */
+static int order[3];
+static int order_cnt;
+
+static void
+record (void *aux)
+{
+    order[order_cnt++] = (int) aux;
+}
+
+static void
+check_priorities (void)
+{
+    struct workqueue wq;
+
+    /* One worker at our priority, so nothing runs until we
+       flush. */
+    if (!workqueue_init (&wq, "order", 1, PRI_DEFAULT))
+        fail ("workqueue_init() failed");
+    workqueue_submit_pri (&wq, record, (void *) PRI_MIN, PRI_MIN);
+    workqueue_submit_pri (&wq, record, (void *) PRI_MAX, PRI_MAX);
+    workqueue_submit (&wq, record, (void *) PRI_DEFAULT);
+    workqueue_flush (&wq);
+    workqueue_destroy (&wq);
+
+    if (order_cnt != 3 || order[0] != PRI_MAX || order[1] != PRI_DEFAULT
+        || order[2] != PRI_MIN)
+        fail ("jobs ran in the wrong order");
+}
+
+void
+test_workqueue_bench (void)
+{
+    ASSERT (!thread_mlfqs);
+
+    check_priorities ();
+    bench_thread_create ();
+    bench_workqueue ("workqueue, preempting", PRI_DEFAULT + 1);
+    bench_workqueue ("workqueue, batched", PRI_DEFAULT);
+    pass ();
+}
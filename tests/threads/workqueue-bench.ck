@@ -0,0 +1,25 @@
+# -*- perl -*-
+
+# Timings vary from run to run, so only check that every method
+# reported a result and the test passed.
+#
+# (workqueue-bench) thread_create: 10000 jobs, 21830 cycles/job
+# (workqueue-bench) workqueue, preempting: 10000 jobs, 4410 cycles/job
+# (workqueue-bench) workqueue, batched: 10000 jobs, 1250 cycles/job
+
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+my (@results) = grep (/: 10000 jobs, \d+ cycles\/job/, @output);
+fail "Expected 3 results but found " . scalar (@results) . ".\n"
+  if @results != 3;
+fail "Benchmark did not report PASS.\n"
+  if !grep (/\(workqueue-bench\) PASS/, @output);
+
+pass;
@@ -0,0 +1,115 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <stdint.h>
+
+/* Maximum number of processors the scheduler keeps run queues
+   for. */
+#define CPU_MAX 8
+
+/* Returns the index of the processor executing the caller, in
+   [0, CPU_MAX).  Only the bootstrap processor is started, so this
+   is always 0; bringing up application processors would make it
+   read the local APIC ID instead. */
+static inline unsigned
+cpu_id (void)
+{
+    return 0;
+}
+
+/* Returns the processor's time-stamp counter, which counts
+   clock cycles since reset.  Intended for measuring short
+   intervals in benchmarks and statistics; it is not
+   synchronized with the timer tick.  See [IA32-v2b] "RDTSC". */
+static inline uint64_t
+rdtsc (void)
+{
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t) hi << 32) | lo;
+}
+
+/* Returns the bit index of the most significant 1-bit in X,
+   which must be nonzero.  Compiles to a single BSR. */
+static inline int
+bit_scan_reverse (uint32_t x)
+{
+    uint32_t idx;
+    asm ("bsrl %1, %0" : "=r"(idx) : "rm"(x) : "cc");
+    return idx;
+}
+
+/* Returns the bit index of the least significant 1-bit in X,
+   which must be nonzero.  Compiles to a single BSF. */
+static inline int
+bit_scan_forward (uint32_t x)
+{
+    uint32_t idx;
+    asm ("bsfl %1, %0" : "=r"(idx) : "rm"(x) : "cc");
+    return idx;
+}
+
+/* Returns the bit index of the most significant 1-bit in the
+   nonzero 64-bit value X. */
+static inline int
+bit_scan_reverse64 (uint64_t x)
+{
+    uint32_t hi = x >> 32;
+    return hi != 0 ? 32 + bit_scan_reverse (hi) : bit_scan_reverse (x);
+}
+
+/* Returns the bit index of the least significant 1-bit in the
+   nonzero 64-bit value X. */
+static inline int
+bit_scan_forward64 (uint64_t x)
+{
+    uint32_t lo = x, hi = x >> 32, idx;
+
+    if (lo != 0)
+        asm ("bsfl %1, %0" : "=r"(idx) : "rm"(lo) : "cc");
+    else
+        {
+            asm ("bsfl %1, %0" : "=r"(idx) : "rm"(hi) : "cc");
+            idx += 32;
+        }
+    return idx;
+}
+
+/* Debug register bits.  See [IA32-v3b] "Debug Registers". */
+#define DR6_B0 0x1              /* Breakpoint 0 condition was met. */
+#define DR7_L0 0x1              /* Enable breakpoint 0. */
+#define DR7_LE 0x100            /* Report data breakpoints exactly. */
+#define DR7_RW0_WRITE 0x10000   /* Breakpoint 0 on data writes... */
+#define DR7_LEN0_4 0xc0000      /* ...to a 4-byte aligned word. */
+
+/* Sets breakpoint 0's linear address to ADDR. */
+static inline void
+write_dr0 (const void *addr)
+{
+    asm volatile ("movl %0, %%dr0" : : "r"(addr));
+}
+
+/* Returns the debug status register. */
+static inline uint32_t
+read_dr6 (void)
+{
+    uint32_t dr6;
+    asm volatile ("movl %%dr6, %0" : "=r"(dr6));
+    return dr6;
+}
+
+/* Sets the debug status register to DR6. */
+static inline void
+write_dr6 (uint32_t dr6)
+{
+    asm volatile ("movl %0, %%dr6" : : "r"(dr6));
+}
+
+/* Sets the debug control register to DR7. */
+static inline void
+write_dr7 (uint32_t dr7)
+{
+    asm volatile ("movl %0, %%dr7" : : "r"(dr7));
+}
+
+#endif /* threads/cpu.h */
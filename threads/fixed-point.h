@@ -0,0 +1,61 @@
+#ifndef THREADS_FIXED_POINT_H
+#define THREADS_FIXED_POINT_H
+
+#include <stdint.h>
+
+/* 17.14 fixed-point arithmetic for the 4.4BSD scheduler.
+
+   A fixed-point number is a signed 32-bit int whose lowest
+   FP_SHIFT bits are the fraction, so real number x is stored as
+   x * 2**14.  The largest representable magnitude is about
+   131,071.  Products and quotients of two fixed-point numbers
+   are computed in 64 bits to avoid overflowing the intermediate
+   result. */
+typedef int fixed_t;
+
+#define FP_SHIFT 14
+#define FP_ONE (1 << FP_SHIFT)
+
+/* Converts integer N to fixed point. */
+static inline fixed_t
+fp_from_int (int n)
+{
+    return n * FP_ONE;
+}
+
+/* Converts X to an integer, rounding toward zero. */
+static inline int
+fp_to_int (fixed_t x)
+{
+    return x / FP_ONE;
+}
+
+/* Converts X to an integer, rounding to nearest. */
+static inline int
+fp_round (fixed_t x)
+{
+    return x >= 0 ? (x + FP_ONE / 2) / FP_ONE : (x - FP_ONE / 2) / FP_ONE;
+}
+
+/* Returns X + N, where N is an integer. */
+static inline fixed_t
+fp_add_int (fixed_t x, int n)
+{
+    return x + n * FP_ONE;
+}
+
+/* Returns X * Y. */
+static inline fixed_t
+fp_mul (fixed_t x, fixed_t y)
+{
+    return (int64_t) x * y / FP_ONE;
+}
+
+/* Returns X / Y. */
+static inline fixed_t
+fp_div (fixed_t x, fixed_t y)
+{
+    return (int64_t) x * FP_ONE / y;
+}
+
+#endif /* threads/fixed-point.h */
@@ -0,0 +1,180 @@
+#include "threads/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Wait queue for one futex word. */
+struct futex
+{
+    struct hash_elem elem;      /* In futex_table. */
+    const void *space;          /* Address space ADDR belongs to. */
+    const int *addr;            /* Address of the futex word. */
+    unsigned refs;              /* Threads using this entry. */
+    unsigned waiters;           /* Threads not yet woken. */
+    struct semaphore sema;      /* Upped once per wakeup. */
+};
+
+/* All futexes that have at least one waiter, keyed by SPACE and
+   ADDR.  Protected by futex_lock. */
+static struct hash futex_table;
+static struct lock futex_lock;
+
+static hash_hash_func futex_hash;
+static hash_less_func futex_less;
+
+/* Initializes the futex table. */
+void
+futex_init (void)
+{
+    hash_init (&futex_table, futex_hash, futex_less, NULL);
+    lock_init (&futex_lock);
+    lock_set_name (&futex_lock, "futex");
+}
+
+/* Returns the address space that the running thread's addresses
+   refer to.  Kernel threads share a single space. */
+static const void *
+current_space (void)
+{
+#ifdef USERPROG
+    return thread_current ()->pagedir;
+#else
+    return NULL;
+#endif
+}
+
+/* Returns the futex for ADDR in the current address space, or a
+   null pointer if no thread is waiting on it.  The caller must
+   hold futex_lock. */
+static struct futex *
+futex_lookup (const int *addr)
+{
+    struct futex key;
+    struct hash_elem *e;
+
+    key.space = current_space ();
+    key.addr = addr;
+    e = hash_find (&futex_table, &key.elem);
+    return e != NULL ? hash_entry (e, struct futex, elem) : NULL;
+}
+
+/* If *ADDR still equals VAL, sleeps until another thread calls
+   futex_wake() on ADDR or, if TIMEOUT is nonnegative, until
+   TIMEOUT ticks have passed.  The comparison and the decision to
+   sleep are atomic with respect to futex_wake(), so a wakeup
+   issued after the caller changed *ADDR is never lost.
+
+   Returns true if woken by futex_wake().  Returns false if *ADDR
+   did not equal VAL, if the wait timed out, or if no memory was
+   available for the wait queue; in each case the caller should
+   re-examine *ADDR and retry as appropriate. */
+bool
+futex_wait (const int *addr, int val, int64_t timeout)
+{
+    struct futex *f;
+    bool woken;
+
+    ASSERT (addr != NULL);
+    ASSERT (!intr_context ());
+
+    lock_acquire (&futex_lock);
+    if (*(volatile const int *) addr != val)
+        {
+            lock_release (&futex_lock);
+            return false;
+        }
+    f = futex_lookup (addr);
+    if (f == NULL)
+        {
+            f = malloc (sizeof *f);
+            if (f == NULL)
+                {
+                    lock_release (&futex_lock);
+                    return false;
+                }
+            f->space = current_space ();
+            f->addr = addr;
+            f->refs = f->waiters = 0;
+            sema_init (&f->sema, 0);
+            sema_set_name (&f->sema, "futex");
+            hash_insert (&futex_table, &f->elem);
+        }
+    f->refs++;
+    f->waiters++;
+    lock_release (&futex_lock);
+
+    if (timeout < 0)
+        {
+            sema_down (&f->sema);
+            woken = true;
+        }
+    else
+        woken = sema_down_timeout (&f->sema, timeout);
+
+    lock_acquire (&futex_lock);
+    if (!woken)
+        {
+            /* A wakeup may have been issued for us after the
+               timeout expired but before we retook the lock.  If
+               so, consume it; otherwise withdraw from the count
+               so that futex_wake() does not wake a ghost. */
+            woken = sema_try_down (&f->sema);
+            if (!woken)
+                f->waiters--;
+        }
+    if (--f->refs == 0)
+        {
+            hash_delete (&futex_table, &f->elem);
+            free (f);
+        }
+    lock_release (&futex_lock);
+
+    return woken;
+}
+
+/* Wakes up to CNT threads waiting on ADDR in the current address
+   space and returns the number woken. */
+int
+futex_wake (const int *addr, int cnt)
+{
+    struct futex *f;
+    int woken = 0;
+
+    ASSERT (addr != NULL);
+
+    lock_acquire (&futex_lock);
+    f = futex_lookup (addr);
+    if (f != NULL)
+        for (; woken < cnt && f->waiters > 0; woken++)
+            {
+                f->waiters--;
+                sema_up (&f->sema);
+            }
+    lock_release (&futex_lock);
+
+    return woken;
+}
+
+/* Returns a hash of futex E's address space and address. */
+static unsigned
+futex_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+    const struct futex *f = hash_entry (e, struct futex, elem);
+    return hash_int ((int) f->addr ^ (int) f->space);
+}
+
+/* Orders futexes A and B by address space, then by address. */
+static bool
+futex_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED)
+{
+    const struct futex *a = hash_entry (a_, struct futex, elem);
+    const struct futex *b = hash_entry (b_, struct futex, elem);
+
+    if (a->space != b->space)
+        return a->space < b->space;
+    return a->addr < b->addr;
+}
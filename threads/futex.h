@@ -0,0 +1,23 @@
+#ifndef THREADS_FUTEX_H
+#define THREADS_FUTEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Futexes ("fast user-space mutexes") let a lock or event count
+   that lives in ordinary memory put its waiters to sleep in the
+   kernel only when there is contention.  The uncontended path is
+   a single atomic instruction on the shared word; futex_wait()
+   and futex_wake() are called only when that instruction shows
+   another thread holds the lock or is waiting for it.
+
+   Wait queues are keyed by the address of the word (and, for
+   user processes, by the process's page directory), created on
+   first use and freed when their last waiter leaves, so there is
+   nothing to initialize or destroy per word. */
+
+void futex_init (void);
+bool futex_wait (const int *addr, int val, int64_t timeout);
+int futex_wake (const int *addr, int cnt);
+
+#endif /* threads/futex.h */
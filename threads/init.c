@@ -15,12 +15,14 @@
 #include "devices/timer.h"
 #include "devices/vga.h"
 #include "devices/rtc.h"
+#include "threads/futex.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/synch.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -64,6 +66,7 @@ static char **read_command_line (void);
 static char **parse_options (char **argv);
 static void run_actions (char **argv);
 static void usage (void);
+static void enable_sched_stats (char **argv);
 
 #ifdef FILESYS
 static void locate_block_devices (void);
@@ -97,6 +100,7 @@ main (void)
     /* Initialize memory system. */
     palloc_init (user_page_limit);
     malloc_init ();
+    futex_init ();
     paging_init ();
 
     /* Segmentation. */
@@ -256,6 +260,18 @@ parse_options (char **argv)
                 random_init (atoi (value));
             else if (!strcmp (name, "-mlfqs"))
                 thread_mlfqs = true;
+            else if (!strcmp (name, "-stride"))
+                thread_stride = true;
+            else if (!strcmp (name, "-tickless"))
+                timer_tickless = true;
+            else if (!strcmp (name, "-tcache"))
+                thread_set_page_cache_size (atoi (value));
+            else if (!strcmp (name, "-spin"))
+                lock_set_spin_limit (atoi (value));
+            else if (!strcmp (name, "-stack-check"))
+                thread_stack_check = true;
+            else if (!strcmp (name, "-rq"))
+                thread_set_runqueue_cnt (atoi (value));
 #ifdef USERPROG
             else if (!strcmp (name, "-ul"))
                 user_page_limit = atoi (value);
@@ -264,6 +280,9 @@ parse_options (char **argv)
                 PANIC ("unknown option `%s' (use -h for help)", name);
         }
 
+    if (thread_mlfqs && thread_stride)
+        PANIC ("-mlfqs and -stride cannot be used together");
+
     /* Initialize the random number generator based on the system
      time.  This has no effect if an "-rs" option was specified.
 
@@ -292,6 +311,23 @@ run_task (char **argv)
     printf ("Execution of '%s' complete.\n", task);
 }
 
+/* Requests per-thread scheduler statistics and a ready latency
+   histogram at shutdown. */
+static void
+enable_sched_stats (char **argv UNUSED)
+{
+    thread_report_sched = true;
+}
+
+#ifdef LOCK_PROFILE
+/* Requests the COUNT most contended named locks at shutdown. */
+static void
+enable_lock_stats (char **argv)
+{
+    lock_profile_enable (atoi (argv[1]));
+}
+#endif
+
 /* Executes all of the actions specified in ARGV[]
    up to the null pointer sentinel. */
 static void
@@ -308,6 +344,10 @@ run_actions (char **argv)
     /* Table of supported actions. */
     static const struct action actions[] = {
         { "run", 2, run_task },
+        { "schedstats", 1, enable_sched_stats },
+#ifdef LOCK_PROFILE
+        { "lockstats", 2, enable_lock_stats },
+#endif
 #ifdef FILESYS
         { "ls", 1, fsutil_ls },
         { "cat", 2, fsutil_cat },
@@ -354,6 +394,10 @@ usage (void)
             "  run 'PROG [ARG...]' Run PROG and wait for it to complete.\n"
 #else
             "  run TEST           Run TEST.\n"
+#endif
+            "  schedstats         Print scheduler statistics at shutdown.\n"
+#ifdef LOCK_PROFILE
+            "  lockstats COUNT    Print the COUNT most contended locks at shutdown.\n"
 #endif
 #ifdef FILESYS
             "  ls                 List files in the root directory.\n"
@@ -377,6 +421,12 @@ usage (void)
 #endif
             "  -rs=SEED           Set random number seed to SEED.\n"
             "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+            "  -stride            Use stride (proportional-share) scheduler.\n"
+            "  -tickless          Stop the periodic timer tick while idle.\n"
+            "  -tcache=COUNT      Keep up to COUNT freed thread pages for reuse.\n"
+            "  -spin=COUNT        Yield up to COUNT times on a busy adaptive lock.\n"
+            "  -stack-check       Report stack use and catch kernel stack overflow.\n"
+            "  -rq=COUNT          Spread threads over COUNT run queues (testing).\n"
 #ifdef USERPROG
             "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -5,6 +5,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -28,19 +30,56 @@
    blocks, we remove all of the arena's blocks from the free list
    and give the arena back to the page allocator.
 
+   Taking the descriptor's lock on every call would make it a
+   serialization point, so each CPU keeps a "magazine" of free
+   blocks per descriptor in front of the free list.  malloc() and
+   free() pop and push magazine rounds with interrupts disabled
+   and take no lock.  Only when a magazine runs empty or full do
+   they take the lock, and then they move half a magazine's worth
+   of blocks to or from the free list at once.  Blocks sitting in
+   a magazine count as in use as far as their arena is concerned,
+   so a magazine can keep an otherwise empty arena alive; the
+   magazine size is capped at one arena's worth of blocks to bound
+   that.
+
    We can't handle blocks bigger than 2 kB using this scheme,
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
    the beginning of the allocated block's arena header. */
 
+/* Maximum number of blocks in a magazine. */
+#define MAG_ROUNDS 32
+
+/* Per-CPU cache of free blocks for one descriptor. */
+struct magazine
+{
+    size_t cnt;                         /* Number of rounds. */
+    struct block *rounds[MAG_ROUNDS];   /* Free blocks, LIFO. */
+};
+
 /* Descriptor. */
 struct desc
 {
     size_t block_size;       /* Size of each element in bytes. */
     size_t blocks_per_arena; /* Number of blocks in an arena. */
+    size_t mag_size;         /* Capacity of each magazine. */
+    size_t mag_batch;        /* Blocks moved per refill or drain. */
+    struct magazine mags[CPU_MAX]; /* Per-CPU magazines. */
     struct list free_list;   /* List of free blocks. */
     struct lock lock;        /* Lock. */
+
+    /* Statistics, updated under LOCK.  Readers only disable
+       interrupts, so that the numbers can be printed at shutdown
+       even if the lock is held; the updates are ordered so that a
+       reader never sees more free blocks than the arenas hold. */
+    size_t arena_cnt;        /* Arenas owned. */
+    size_t free_cnt;         /* Blocks in FREE_LIST. */
+    unsigned long long refills; /* Magazine refills. */
+    unsigned long long drains;  /* Magazine drains. */
+#ifdef LOCK_PROFILE
+    char name[16];           /* Lock name, e.g. "malloc 64". */
+#endif
 };
 
 /* Magic number for detecting arena corruption. */
@@ -66,6 +105,9 @@ static size_t desc_cnt;       /* Number of descriptors. */
 
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
+static size_t desc_get (struct desc *, struct block **, size_t cnt);
+static void desc_put (struct desc *, struct block **, size_t cnt);
+static void desc_get_stats (struct desc *, struct malloc_stats *);
 
 /* Initializes the malloc() descriptors. */
 void
@@ -79,8 +121,15 @@ malloc_init (void)
             ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
             d->block_size = block_size;
             d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
+            d->mag_size = (d->blocks_per_arena < MAG_ROUNDS
+                           ? d->blocks_per_arena : MAG_ROUNDS);
+            d->mag_batch = DIV_ROUND_UP (d->mag_size, 2);
             list_init (&d->free_list);
-            lock_init (&d->lock);
+            lock_init_adaptive (&d->lock);
+#ifdef LOCK_PROFILE
+            snprintf (d->name, sizeof d->name, "malloc %zu", block_size);
+            lock_set_name (&d->lock, d->name);
+#endif
         }
 }
 
@@ -92,6 +141,10 @@ malloc (size_t size)
     struct desc *d;
     struct block *b;
     struct arena *a;
+    struct magazine *m;
+    struct block *batch[MAG_ROUNDS / 2];
+    enum intr_level old_level;
+    size_t cnt;
 
     /* A null pointer satisfies a request for 0 bytes. */
     if (size == 0)
@@ -119,37 +172,31 @@ malloc (size_t size)
             return a + 1;
         }
 
-    lock_acquire (&d->lock);
-
-    /* If the free list is empty, create a new arena. */
-    if (list_empty (&d->free_list))
+    /* Take a block from this CPU's magazine if it has one. */
+    old_level = intr_disable ();
+    m = &d->mags[cpu_id ()];
+    if (m->cnt > 0)
         {
-            size_t i;
-
-            /* Allocate a page. */
-            a = palloc_get_page (0);
-            if (a == NULL)
-                {
-                    lock_release (&d->lock);
-                    return NULL;
-                }
-
-            /* Initialize arena and add its blocks to the free list. */
-            a->magic = ARENA_MAGIC;
-            a->desc = d;
-            a->free_cnt = d->blocks_per_arena;
-            for (i = 0; i < d->blocks_per_arena; i++)
-                {
-                    struct block *b = arena_to_block (a, i);
-                    list_push_back (&d->free_list, &b->free_elem);
-                }
+            b = m->rounds[--m->cnt];
+            intr_set_level (old_level);
+            return b;
         }
+    intr_set_level (old_level);
 
-    /* Get a block from free list and return it. */
-    b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
-    a = block_to_arena (b);
-    a->free_cnt--;
-    lock_release (&d->lock);
+    /* Otherwise refill it from the descriptor.  Another thread
+       may have refilled it while we held the lock, in which case
+       whatever doesn't fit goes back. */
+    cnt = desc_get (d, batch, d->mag_batch);
+    if (cnt == 0)
+        return NULL;
+    b = batch[--cnt];
+    old_level = intr_disable ();
+    m = &d->mags[cpu_id ()];
+    while (cnt > 0 && m->cnt < d->mag_size)
+        m->rounds[m->cnt++] = batch[--cnt];
+    intr_set_level (old_level);
+    if (cnt > 0)
+        desc_put (d, batch, cnt);
     return b;
 }
 
@@ -223,6 +270,9 @@ free (void *p)
             struct block *b = p;
             struct arena *a = block_to_arena (b);
             struct desc *d = a->desc;
+            struct magazine *m;
+            struct block *batch[MAG_ROUNDS / 2];
+            enum intr_level old_level;
 
             if (d != NULL)
                 {
@@ -233,26 +283,24 @@ free (void *p)
                     memset (b, 0xcc, d->block_size);
 #endif
 
-                    lock_acquire (&d->lock);
-
-                    /* Add block to free list. */
-                    list_push_front (&d->free_list, &b->free_elem);
-
-                    /* If the arena is now entirely unused, free it. */
-                    if (++a->free_cnt >= d->blocks_per_arena)
+                    /* Put the block in this CPU's magazine.  If the
+                       magazine is full, move half of it back to the
+                       descriptor first. */
+                    old_level = intr_disable ();
+                    m = &d->mags[cpu_id ()];
+                    if (m->cnt < d->mag_size)
                         {
-                            size_t i;
-
-                            ASSERT (a->free_cnt == d->blocks_per_arena);
-                            for (i = 0; i < d->blocks_per_arena; i++)
-                                {
-                                    struct block *b = arena_to_block (a, i);
-                                    list_remove (&b->free_elem);
-                                }
-                            palloc_free_page (a);
+                            m->rounds[m->cnt++] = b;
+                            intr_set_level (old_level);
+                            return;
                         }
+                    m->cnt -= d->mag_batch;
+                    memcpy (batch, m->rounds + m->cnt,
+                            d->mag_batch * sizeof *batch);
+                    m->rounds[m->cnt++] = b;
+                    intr_set_level (old_level);
 
-                    lock_release (&d->lock);
+                    desc_put (d, batch, d->mag_batch);
                 }
             else
                 {
@@ -263,6 +311,153 @@ free (void *p)
         }
 }
 
+/* Takes up to CNT free blocks from D, creating arenas as needed,
+   and stores them in BLOCKS.  Returns the number of blocks taken,
+   which is less than CNT only if memory ran out. */
+static size_t
+desc_get (struct desc *d, struct block **blocks, size_t cnt)
+{
+    size_t taken;
+
+    lock_acquire (&d->lock);
+    for (taken = 0; taken < cnt; taken++)
+        {
+            struct block *b;
+            struct arena *a;
+
+            /* If the free list is empty, create a new arena. */
+            if (list_empty (&d->free_list))
+                {
+                    size_t i;
+
+                    /* Allocate a page. */
+                    a = palloc_get_page (0);
+                    if (a == NULL)
+                        break;
+
+                    /* Initialize arena and add its blocks to the free
+                       list. */
+                    a->magic = ARENA_MAGIC;
+                    a->desc = d;
+                    a->free_cnt = d->blocks_per_arena;
+                    for (i = 0; i < d->blocks_per_arena; i++)
+                        {
+                            b = arena_to_block (a, i);
+                            list_push_back (&d->free_list, &b->free_elem);
+                        }
+                    d->arena_cnt++;
+                    d->free_cnt += d->blocks_per_arena;
+                }
+
+            /* Get a block from free list. */
+            b = list_entry (list_pop_front (&d->free_list), struct block,
+                            free_elem);
+            a = block_to_arena (b);
+            a->free_cnt--;
+            d->free_cnt--;
+            blocks[taken] = b;
+        }
+    d->refills++;
+    lock_release (&d->lock);
+    return taken;
+}
+
+/* Returns the CNT blocks in BLOCKS to D's free list, giving back
+   to the page allocator any arena left with no blocks in use. */
+static void
+desc_put (struct desc *d, struct block **blocks, size_t cnt)
+{
+    size_t i;
+
+    lock_acquire (&d->lock);
+    for (i = 0; i < cnt; i++)
+        {
+            struct block *b = blocks[i];
+            struct arena *a = block_to_arena (b);
+
+            /* Add block to free list. */
+            list_push_front (&d->free_list, &b->free_elem);
+            d->free_cnt++;
+
+            /* If the arena is now entirely unused, free it. */
+            if (++a->free_cnt >= d->blocks_per_arena)
+                {
+                    size_t j;
+
+                    ASSERT (a->free_cnt == d->blocks_per_arena);
+                    for (j = 0; j < d->blocks_per_arena; j++)
+                        {
+                            struct block *b = arena_to_block (a, j);
+                            list_remove (&b->free_elem);
+                        }
+                    palloc_free_page (a);
+                    d->free_cnt -= d->blocks_per_arena;
+                    d->arena_cnt--;
+                }
+        }
+    d->drains++;
+    lock_release (&d->lock);
+}
+
+/* Adds to S how the blocks of descriptor D are used.  The
+   numbers are a snapshot and may be stale by the time the caller
+   reads them. */
+static void
+desc_get_stats (struct desc *d, struct malloc_stats *s)
+{
+    enum intr_level old_level = intr_disable ();
+    size_t cached = 0;
+    size_t cpu;
+
+    for (cpu = 0; cpu < CPU_MAX; cpu++)
+        cached += d->mags[cpu].cnt;
+    s->arenas += d->arena_cnt;
+    s->used_bytes += ((d->arena_cnt * d->blocks_per_arena
+                       - d->free_cnt - cached) * d->block_size);
+    s->free_bytes += d->free_cnt * d->block_size;
+    s->cached_bytes += cached * d->block_size;
+    s->refills += d->refills;
+    s->drains += d->drains;
+    intr_set_level (old_level);
+}
+
+/* Fills S with the totals across all descriptors.  Big blocks,
+   which come straight from the page allocator, are not
+   counted. */
+void
+malloc_get_stats (struct malloc_stats *s)
+{
+    struct desc *d;
+
+    memset (s, 0, sizeof *s);
+    for (d = descs; d < descs + desc_cnt; d++)
+        desc_get_stats (d, s);
+}
+
+/* Prints, for each block size in use, how much of its arenas is
+   allocated, on the descriptor's free list, or cached in
+   magazines, and how often the magazines went to the
+   descriptor. */
+void
+malloc_print_stats (void)
+{
+    struct desc *d;
+
+    for (d = descs; d < descs + desc_cnt; d++)
+        {
+            struct malloc_stats s;
+
+            memset (&s, 0, sizeof s);
+            desc_get_stats (d, &s);
+            if (s.arenas == 0 && s.refills == 0)
+                continue;
+            printf ("Malloc: %zu-byte blocks: %zu arenas, %zu bytes used, "
+                    "%zu free, %zu cached, %llu refills, %llu drains\n",
+                    d->block_size, s.arenas, s.used_bytes, s.free_bytes,
+                    s.cached_bytes, s.refills, s.drains);
+        }
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b)
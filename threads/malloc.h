@@ -4,10 +4,23 @@
 #include <debug.h>
 #include <stddef.h>
 
+/* How the small-block arenas are used. */
+struct malloc_stats
+{
+    size_t arenas;              /* Pages holding small blocks. */
+    size_t used_bytes;          /* Bytes in allocated blocks. */
+    size_t free_bytes;          /* Bytes on descriptors' free lists. */
+    size_t cached_bytes;        /* Bytes in per-CPU magazines. */
+    unsigned long long refills; /* Magazine refills from descriptors. */
+    unsigned long long drains;  /* Magazine drains to descriptors. */
+};
+
 void malloc_init (void);
 void *malloc (size_t) __attribute__ ((malloc));
 void *calloc (size_t, size_t) __attribute__ ((malloc));
 void *realloc (void *, size_t);
 void free (void *);
+void malloc_get_stats (struct malloc_stats *);
+void malloc_print_stats (void);
 
 #endif /* threads/malloc.h */
@@ -2,13 +2,15 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
-#include "threads/synch.h"
 #include "threads/vaddr.h"
 
 /* Page allocator.  Hands out memory in page-size (or
@@ -23,14 +25,41 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Each pool is a binary buddy allocator.  Free pages are kept in
+   blocks of 2**K pages, aligned to 2**K pages from the pool base,
+   on one free list per order K.  An allocation of N pages takes
+   the smallest free block of at least N pages, splitting larger
+   blocks as needed, and returns the unused tail of the block to
+   the free lists.  Freeing a block merges it with its buddy, the
+   other half of the next larger block, for as long as the buddy
+   is free too.  Both take O(log n) steps in the size of the pool,
+   so allocation and freeing are done with interrupts disabled
+   instead of under a lock, which also lets the scheduler free a
+   dying thread's page.
+
+   When no block is large enough but N contiguous pages are free
+   anyway, because they straddle block boundaries, the allocator
+   falls back to a linear scan of the page bitmap and carves the
+   pages out of the blocks that hold them. */
+
+/* Marks a page that does not begin a free block. */
+#define NOT_HEAD 0xff
 
 /* A memory pool. */
 struct pool
 {
-    struct lock lock;        /* Mutual exclusion. */
-    struct bitmap *used_map; /* Bitmap of free pages. */
-    uint8_t *base;           /* Base of pool. */
+    struct bitmap *used_map;    /* Bitmap of free pages. */
+    uint8_t *free_order;        /* Per page: order of the free block it
+                                   begins, or NOT_HEAD. */
+    struct list free_lists[PALLOC_ORDERS]; /* Free blocks, by order. */
+    uint32_t nonempty;          /* Bit K set if free_lists[K] nonempty. */
+    size_t block_cnt[PALLOC_ORDERS]; /* Length of each free list. */
+    size_t free_cnt;            /* Number of free pages. */
+    unsigned long long scans;   /* Allocations that needed a scan. */
+    uint8_t *base;              /* Base of pool. */
+    const char *name;           /* Name (for statistics). */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -39,6 +68,8 @@ static struct pool kernel_pool, user_pool;
 static void init_pool (struct pool *, void *base, size_t page_cnt,
                        const char *name);
 static bool page_from_pool (const struct pool *, void *page);
+static size_t buddy_alloc (struct pool *, size_t page_cnt);
+static void free_range (struct pool *, size_t page_idx, size_t page_cnt);
 
 /* Initializes the page allocator.  At most USER_PAGE_LIMIT
    pages are put into the user pool. */
@@ -73,13 +104,16 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
     struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
     void *pages;
     size_t page_idx;
+    enum intr_level old_level;
 
     if (page_cnt == 0)
         return NULL;
 
-    lock_acquire (&pool->lock);
-    page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-    lock_release (&pool->lock);
+    old_level = intr_disable ();
+    page_idx = buddy_alloc (pool, page_cnt);
+    if (page_idx != BITMAP_ERROR)
+        bitmap_set_multiple (pool->used_map, page_idx, page_cnt, true);
+    intr_set_level (old_level);
 
     if (page_idx != BITMAP_ERROR)
         pages = pool->base + PGSIZE * page_idx;
@@ -119,6 +153,7 @@ palloc_free_multiple (void *pages, size_t page_cnt)
 {
     struct pool *pool;
     size_t page_idx;
+    enum intr_level old_level;
 
     ASSERT (pg_ofs (pages) == 0);
     if (pages == NULL || page_cnt == 0)
@@ -137,8 +172,11 @@ palloc_free_multiple (void *pages, size_t page_cnt)
     memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
 
+    old_level = intr_disable ();
     ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
     bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+    free_range (pool, page_idx, page_cnt);
+    intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -148,15 +186,57 @@ palloc_free_page (void *page)
     palloc_free_multiple (page, 1);
 }
 
+/* Fills in *STATS for the user pool if PAL_USER is set in
+   FLAGS, otherwise for the kernel pool. */
+void
+palloc_get_stats (enum palloc_flags flags, struct palloc_stats *stats)
+{
+    struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+    enum intr_level old_level = intr_disable ();
+    int order;
+
+    stats->total_pages = bitmap_size (pool->used_map);
+    stats->free_pages = pool->free_cnt;
+    stats->largest_free = (pool->nonempty != 0
+                           ? (size_t) 1 << bit_scan_reverse (pool->nonempty)
+                           : 0);
+    for (order = 0; order < PALLOC_ORDERS; order++)
+        stats->free_blocks[order] = pool->block_cnt[order];
+    stats->scans = pool->scans;
+    intr_set_level (old_level);
+}
+
+/* Prints free space and fragmentation of each pool. */
+void
+palloc_print_stats (void)
+{
+    static const enum palloc_flags pools[] = { 0, PAL_USER };
+    size_t i;
+
+    for (i = 0; i < sizeof pools / sizeof *pools; i++)
+        {
+            struct palloc_stats s;
+
+            palloc_get_stats (pools[i], &s);
+            printf ("Palloc: %s: %zu of %zu pages free, "
+                    "largest free block %zu pages, %llu scans\n",
+                    pools[i] & PAL_USER ? user_pool.name : kernel_pool.name,
+                    s.free_pages, s.total_pages, s.largest_free, s.scans);
+        }
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void
 init_pool (struct pool *p, void *base, size_t page_cnt, const char *name)
 {
-    /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
+    /* We'll put the pool's used_map and free_order at its base.
+     Calculate the space needed for them
      and subtract it from the pool's size. */
-    size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
+    size_t bm_size = bitmap_buf_size (page_cnt);
+    size_t bm_pages = DIV_ROUND_UP (bm_size + page_cnt, PGSIZE);
+    int order;
+
     if (bm_pages > page_cnt)
         PANIC ("Not enough memory in %s for bitmap.", name);
     page_cnt -= bm_pages;
@@ -164,9 +244,192 @@ init_pool (struct pool *p, void *base, size_t page_cnt, const char *name)
     printf ("%zu pages available in %s.\n", page_cnt, name);
 
     /* Initialize the pool. */
-    lock_init (&p->lock);
-    p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
+    p->used_map = bitmap_create_in_buf (page_cnt, base, bm_size);
+    p->free_order = (uint8_t *) base + bm_size;
+    memset (p->free_order, NOT_HEAD, page_cnt);
+    for (order = 0; order < PALLOC_ORDERS; order++)
+        {
+            list_init (&p->free_lists[order]);
+            p->block_cnt[order] = 0;
+        }
+    p->nonempty = 0;
+    p->free_cnt = 0;
+    p->scans = 0;
     p->base = base + bm_pages * PGSIZE;
+    p->name = name;
+
+    free_range (p, 0, page_cnt);
+}
+
+/* Returns the list element stored in the first page of the free
+   block at PAGE_IDX in POOL. */
+static struct list_elem *
+block_elem (const struct pool *pool, size_t page_idx)
+{
+    return (struct list_elem *) (pool->base + PGSIZE * page_idx);
+}
+
+/* Returns the index of the page whose list element is E. */
+static size_t
+block_idx (const struct pool *pool, struct list_elem *e)
+{
+    return pg_no (e) - pg_no (pool->base);
+}
+
+/* Adds the free block of 2**ORDER pages at PAGE_IDX to POOL's
+   free lists. */
+static void
+block_push (struct pool *pool, size_t page_idx, int order)
+{
+    pool->free_order[page_idx] = order;
+    list_push_front (&pool->free_lists[order], block_elem (pool, page_idx));
+    pool->nonempty |= 1u << order;
+    pool->block_cnt[order]++;
+    pool->free_cnt += (size_t) 1 << order;
+}
+
+/* Removes the free block of 2**ORDER pages at PAGE_IDX from
+   POOL's free lists. */
+static void
+block_remove (struct pool *pool, size_t page_idx, int order)
+{
+    ASSERT (pool->free_order[page_idx] == order);
+
+    pool->free_order[page_idx] = NOT_HEAD;
+    list_remove (block_elem (pool, page_idx));
+    if (list_empty (&pool->free_lists[order]))
+        pool->nonempty &= ~(1u << order);
+    pool->block_cnt[order]--;
+    pool->free_cnt -= (size_t) 1 << order;
+}
+
+/* Frees the block of 2**ORDER pages at PAGE_IDX, first merging
+   it with its buddy for as long as the buddy is free. */
+static void
+free_block (struct pool *pool, size_t page_idx, int order)
+{
+    size_t page_cnt = bitmap_size (pool->used_map);
+
+    while (order + 1 < PALLOC_ORDERS)
+        {
+            size_t buddy = page_idx ^ ((size_t) 1 << order);
+
+            if (buddy >= page_cnt || pool->free_order[buddy] != order)
+                break;
+            block_remove (pool, buddy, order);
+            page_idx &= ~((size_t) 1 << order);
+            order++;
+        }
+    block_push (pool, page_idx, order);
+}
+
+/* Frees the PAGE_CNT pages starting at PAGE_IDX, which need not
+   be a buddy block, as the fewest aligned blocks that cover
+   them. */
+static void
+free_range (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+    while (page_cnt > 0)
+        {
+            int order = bit_scan_reverse (page_cnt);
+
+            if (page_idx != 0 && bit_scan_forward64 (page_idx) < order)
+                order = bit_scan_forward64 (page_idx);
+            if (order >= PALLOC_ORDERS)
+                order = PALLOC_ORDERS - 1;
+            free_block (pool, page_idx, order);
+            page_idx += (size_t) 1 << order;
+            page_cnt -= (size_t) 1 << order;
+        }
+}
+
+/* Returns the index of the first page of the free block in POOL
+   that contains page PAGE_IDX, and stores its order in *ORDER. */
+static size_t
+find_block (const struct pool *pool, size_t page_idx, int *order)
+{
+    int k;
+
+    for (k = 0; k < PALLOC_ORDERS; k++)
+        {
+            size_t head = page_idx & ~(((size_t) 1 << k) - 1);
+            if (pool->free_order[head] == k)
+                {
+                    *order = k;
+                    return head;
+                }
+        }
+    NOT_REACHED ();
+}
+
+/* Takes the PAGE_CNT free pages starting at PAGE_IDX out of the
+   blocks that hold them, returning whatever else those blocks
+   held to the free lists. */
+static void
+carve_range (struct pool *pool, size_t page_idx, size_t page_cnt)
+{
+    size_t end = page_idx + page_cnt;
+    size_t first, last = 0;
+    size_t p;
+    int order;
+
+    /* Remove every block that overlaps the range before freeing
+       the leftovers, so that they cannot merge back into blocks
+       inside the range. */
+    first = find_block (pool, page_idx, &order);
+    for (p = page_idx; p < end; p = last)
+        {
+            size_t head = find_block (pool, p, &order);
+            block_remove (pool, head, order);
+            last = head + ((size_t) 1 << order);
+        }
+    free_range (pool, first, page_idx - first);
+    free_range (pool, end, last - end);
+}
+
+/* Allocates PAGE_CNT contiguous pages from POOL and returns the
+   index of the first, or BITMAP_ERROR if POOL has no PAGE_CNT
+   contiguous free pages. */
+static size_t
+buddy_alloc (struct pool *pool, size_t page_cnt)
+{
+    int order = page_cnt > 1 ? bit_scan_reverse (page_cnt - 1) + 1 : 0;
+    uint32_t avail;
+    size_t page_idx;
+    int k;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    avail = order < PALLOC_ORDERS ? pool->nonempty & ~((1u << order) - 1) : 0;
+    if (avail == 0)
+        {
+            /* No block is big enough.  The pages may still be free
+               across block boundaries. */
+            if (page_cnt > pool->free_cnt)
+                return BITMAP_ERROR;
+            page_idx = bitmap_scan (pool->used_map, 0, page_cnt, false);
+            if (page_idx != BITMAP_ERROR)
+                {
+                    carve_range (pool, page_idx, page_cnt);
+                    pool->scans++;
+                }
+            return page_idx;
+        }
+
+    /* Take the smallest big enough block and split it in halves
+       until it is no larger than needed. */
+    k = bit_scan_forward64 (avail);
+    page_idx = block_idx (pool, list_front (&pool->free_lists[k]));
+    block_remove (pool, page_idx, k);
+    while (k > order)
+        {
+            k--;
+            block_push (pool, page_idx + ((size_t) 1 << k), k);
+        }
+
+    /* Give back the unused tail of the block. */
+    free_range (pool, page_idx + page_cnt, ((size_t) 1 << order) - page_cnt);
+    return page_idx;
 }
 
 /* Returns true if PAGE was allocated from POOL,
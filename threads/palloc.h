@@ -11,10 +11,27 @@ enum palloc_flags
     PAL_USER = 004    /* User page. */
 };
 
+/* Number of buddy block sizes: free blocks hold 2**K pages for K
+   in [0, PALLOC_ORDERS). */
+#define PALLOC_ORDERS 20
+
+/* Free space and fragmentation of a pool. */
+struct palloc_stats
+{
+    size_t total_pages;                 /* Pages in the pool. */
+    size_t free_pages;                  /* Pages not allocated. */
+    size_t largest_free;                /* Pages in the largest free block. */
+    size_t free_blocks[PALLOC_ORDERS];  /* Free blocks of 2**K pages. */
+    unsigned long long scans;           /* Allocations that fell back to
+                                           scanning the page bitmap. */
+};
+
 void palloc_init (size_t user_page_limit);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+void palloc_get_stats (enum palloc_flags, struct palloc_stats *);
+void palloc_print_stats (void);
 
 #endif /* threads/palloc.h */
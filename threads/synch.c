@@ -2,6 +2,215 @@
 #include <stdio.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "devices/timer.h"
+#ifdef LOCK_PROFILE
+#include <string.h>
+#include "threads/cpu.h"
+#endif
+
+/* -------------------- 대기 큐 -------------------- */
+
+/* 같은 우선순위끼리는 head 하나 뒤에 FIFO로 줄을 서므로, heads는
+   우선순위마다 스레드가 하나뿐이다.  맨 앞 head가 항상 최고
+   우선순위라 깨울 때 정렬이 필요 없다. */
+
+static void
+waitq_init (struct waitq *q) {
+  list_init (&q->heads);
+}
+
+static bool
+waitq_empty (struct waitq *q) {
+  return list_empty (&q->heads);
+}
+
+/* Q에서 가장 높은 우선순위.  Q가 비어 있으면 PRI_MIN - 1. */
+static int
+waitq_max_priority (struct waitq *q) {
+  if (waitq_empty (q))
+    return PRI_MIN - 1;
+  return list_entry (list_front (&q->heads), struct thread, elem)->priority;
+}
+
+/* T를 Q에서 T의 우선순위 줄 맨 뒤에 넣는다.  heads만 훑으므로
+   기다리는 스레드 수와 관계없이 최대 PRI_CNT 단계다. */
+static void
+waitq_push (struct waitq *q, struct thread *t) {
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->waitq == NULL);
+
+  t->waitq = q;
+  for (e = list_begin (&q->heads); e != list_end (&q->heads); e = list_next (e)) {
+    struct thread *head = list_entry (e, struct thread, elem);
+    if (head->priority == t->priority) {
+      t->wait_head = false;
+      list_push_back (&head->wait_peers, &t->elem);
+      return;
+    }
+    if (head->priority < t->priority)
+      break;
+  }
+  t->wait_head = true;
+  list_init (&t->wait_peers);
+  list_insert (e, &t->elem);
+}
+
+/* T를 자신이 있는 큐에서 뺀다.  T가 head였다면 같은 우선순위의
+   다음 스레드가 나머지 줄을 넘겨받아 head 자리를 잇는다. */
+static void
+waitq_remove (struct thread *t) {
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->waitq != NULL);
+
+  if (t->wait_head && !list_empty (&t->wait_peers)) {
+    struct thread *next = list_entry (list_pop_front (&t->wait_peers), struct thread, elem);
+    next->wait_head = true;
+    list_init (&next->wait_peers);
+    list_splice (list_end (&next->wait_peers),
+                 list_begin (&t->wait_peers), list_end (&t->wait_peers));
+    list_insert (&t->elem, &next->elem);
+  }
+  list_remove (&t->elem);
+  t->waitq = NULL;
+}
+
+/* Q에서 가장 높은 우선순위의 스레드를 꺼낸다.  시간 제한을 두고
+   기다리던 스레드면 sleep wheel에서도 뺀다. */
+static struct thread *
+waitq_pop (struct waitq *q) {
+  struct thread *t = list_entry (list_front (&q->heads), struct thread, elem);
+  waitq_remove (t);
+  thread_cancel_timeout (t);
+  return t;
+}
+
+/* Q에서 기다리는 스레드를 모두 깨운다.  인터럽트가 꺼진 상태에서
+   호출하며, 양보는 호출자가 한다. */
+static void
+waitq_wake_all (struct waitq *q) {
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (!waitq_empty (q))
+    thread_unblock (waitq_pop (q));
+}
+
+/* 기한이 되어 깨어나는 T를 기다리던 큐에서 뺀다.  thread_wakeup()이
+   호출한다. */
+void
+waitq_cancel (struct thread *t) {
+  waitq_remove (t);
+}
+
+/* 큐에서 기다리는 T의 우선순위를 PRIORITY로 바꾸고 새 우선순위
+   줄의 맨 뒤로 옮긴다.  thread.c가 기다리는 스레드의 우선순위를
+   바꿀 때(기부, MLFQS) 호출한다. */
+void
+waitq_change_priority (struct thread *t, int priority) {
+  struct waitq *q = t->waitq;
+
+  ASSERT (t->status == THREAD_BLOCKED);
+  ASSERT (q != NULL);
+
+  waitq_remove (t);
+  t->priority = priority;
+  waitq_push (q, t);
+}
+
+/* -------------------- 경합 프로파일 -------------------- */
+
+#ifdef LOCK_PROFILE
+/* 이름이 붙은 세마포어/락의 sync_profile 목록 */
+static struct list named_list = LIST_INITIALIZER (named_list);
+
+/* 종료할 때 보고할 개수.  0이면 보고하지 않는다. */
+static size_t profile_top_cnt;
+
+/* P로 한 번 획득했음을 기록한다.  기다렸다면 WAIT_START는 기다리기
+   시작한 tick이다. */
+static void
+profile_acquire (struct sync_profile *p, bool contended, int64_t wait_start) {
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  p->acquires++;
+  if (contended) {
+    p->contended++;
+    p->wait_ticks += timer_ticks () - wait_start;
+  }
+}
+
+/* 락을 잡기 시작한 시각을 기록한다. */
+static void
+profile_hold (struct lock *lock) {
+  lock->semaphore.profile.hold_start = rdtsc ();
+}
+
+/* 락을 놓을 때 이번에 잡고 있던 시간으로 최댓값을 갱신한다. */
+static void
+profile_release (struct lock *lock) {
+  struct sync_profile *p = &lock->semaphore.profile;
+  uint64_t held = rdtsc () - p->hold_start;
+
+  if (held > p->max_hold)
+    p->max_hold = held;
+}
+
+void
+sema_set_name (struct semaphore *sema, const char *name) {
+  enum intr_level old_level = intr_disable ();
+
+  if (sema->profile.name == NULL)
+    list_push_back (&named_list, &sema->profile.elem);
+  sema->profile.name = name;
+  intr_set_level (old_level);
+}
+
+void
+lock_set_name (struct lock *lock, const char *name) {
+  sema_set_name (&lock->semaphore, name);
+}
+
+/* 종료할 때 경합이 가장 많은 TOP_CNT개를 출력하게 한다. */
+void
+lock_profile_enable (size_t top_cnt) {
+  profile_top_cnt = top_cnt;
+}
+
+/* 경합 횟수 내림차순 비교자 */
+static bool
+profile_more (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED) {
+  const struct sync_profile *pa = list_entry (a, struct sync_profile, elem);
+  const struct sync_profile *pb = list_entry (b, struct sync_profile, elem);
+  return pa->contended > pb->contended;
+}
+
+/* lock_profile_enable()로 요청했으면 경합이 가장 많은 세마포어와
+   락을 출력한다.  종료 직전에 thread_print_stats()와 함께 불린다. */
+void
+lock_profile_print (void) {
+  enum intr_level old_level;
+  struct list_elem *e;
+  size_t i;
+
+  if (profile_top_cnt == 0)
+    return;
+
+  old_level = intr_disable ();
+  list_sort (&named_list, profile_more, NULL);
+  printf ("Lock profile: top %zu of %zu named locks by contention\n",
+          profile_top_cnt, list_size (&named_list));
+  printf ("  %-16s %12s %12s %12s %16s\n",
+          "name", "acquires", "contended", "wait ticks", "max hold cycles");
+  for (e = list_begin (&named_list), i = 0;
+       e != list_end (&named_list) && i < profile_top_cnt; e = list_next (e), i++) {
+    const struct sync_profile *p = list_entry (e, struct sync_profile, elem);
+    printf ("  %-16s %12llu %12llu %12lld %16llu\n", p->name,
+            p->acquires, p->contended, p->wait_ticks, p->max_hold);
+  }
+  intr_set_level (old_level);
+}
+#endif
 
 /* -------------------- 세마포어 -------------------- */
 
@@ -9,15 +218,10 @@ void
 sema_init (struct semaphore *sema, unsigned value) {
   ASSERT (sema != NULL);
   sema->value = value;
-  list_init (&sema->waiters);
-}
-
-/* waiters에서 thread 우선순위 비교 (내림차순: 큰게 먼저) */
-static bool
-thread_pri_more (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED) {
-  const struct thread *ta = list_entry (a, struct thread, elem);
-  const struct thread *tb = list_entry (b, struct thread, elem);
-  return ta->priority > tb->priority;
+  waitq_init (&sema->waiters);
+#ifdef LOCK_PROFILE
+  memset (&sema->profile, 0, sizeof sema->profile);
+#endif
 }
 
 void
@@ -27,12 +231,19 @@ sema_down (struct semaphore *sema) {
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
+#ifdef LOCK_PROFILE
+  bool contended = sema->value == 0;
+  int64_t wait_start = contended ? timer_ticks () : 0;
+#endif
   while (sema->value == 0) {
-    /* 대기열을 priority 순서로 삽입 */
-    list_insert_ordered (&sema->waiters, &thread_current ()->elem, thread_pri_more, NULL);
+    /* 대기 큐에 priority 순서로 삽입 */
+    waitq_push (&sema->waiters, thread_current ());
     thread_block ();
   }
   sema->value--;
+#ifdef LOCK_PROFILE
+  profile_acquire (&sema->profile, contended, wait_start);
+#endif
   intr_set_level (old_level);
 }
 
@@ -45,6 +256,9 @@ sema_try_down (struct semaphore *sema) {
   old_level = intr_disable ();
   if (sema->value > 0) {
     sema->value--;
+#ifdef LOCK_PROFILE
+    profile_acquire (&sema->profile, false, 0);
+#endif
     success = true;
   } else {
     success = false;
@@ -54,22 +268,68 @@ sema_try_down (struct semaphore *sema) {
   return success;
 }
 
-void
-sema_up (struct semaphore *sema) {
+/* SEMA를 내리되, TIMEOUT tick 안에 내리지 못하면 포기한다.
+   TIMEOUT이 0 이하면 sema_try_down()과 같다.  내렸으면 true. */
+bool
+sema_down_timeout (struct semaphore *sema, int64_t timeout) {
   enum intr_level old_level;
+  int64_t deadline;
+  bool success = true;
+
   ASSERT (sema != NULL);
+  ASSERT (!intr_context ());
 
   old_level = intr_disable ();
+  deadline = timer_ticks () + timeout;
+#ifdef LOCK_PROFILE
+  bool contended = sema->value == 0;
+  int64_t wait_start = timer_ticks ();
+#endif
+  while (sema->value == 0) {
+    if (timer_ticks () >= deadline) {
+      success = false;
+      break;
+    }
+    waitq_push (&sema->waiters, thread_current ());
+    if (thread_block_timeout (deadline)) {
+      success = false;
+      break;
+    }
+  }
+  if (success) {
+    sema->value--;
+#ifdef LOCK_PROFILE
+    profile_acquire (&sema->profile, contended, wait_start);
+#endif
+  }
+  intr_set_level (old_level);
+
+  return success;
+}
+
+/* SEMA를 올리고 최고 우선순위 waiter를 깨운다.  양보는 하지 않으며,
+   깨운 스레드를 반환한다 (없으면 NULL). */
+static struct thread *
+sema_wake (struct semaphore *sema) {
   struct thread *unblocked = NULL;
 
-  if (!list_empty (&sema->waiters)) {
-    /* 안전을 위해 정렬 보장 후 최고 우선순위 pop */
-    list_sort (&sema->waiters, thread_pri_more, NULL);
-    struct list_elem *e = list_pop_front (&sema->waiters);
-    unblocked = list_entry (e, struct thread, elem);
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!waitq_empty (&sema->waiters)) {
+    unblocked = waitq_pop (&sema->waiters);
     thread_unblock (unblocked);
   }
   sema->value++;
+  return unblocked;
+}
+
+void
+sema_up (struct semaphore *sema) {
+  enum intr_level old_level;
+  ASSERT (sema != NULL);
+
+  old_level = intr_disable ();
+  struct thread *unblocked = sema_wake (sema);
 
   /* 즉시 선점: 더 높은 우선순위가 깨어났다면 지금 양보 */
   if (unblocked && unblocked->priority > thread_current ()->priority) {
@@ -84,41 +344,252 @@ sema_up (struct semaphore *sema) {
 
 /* -------------------- 락 -------------------- */
 
+/* adaptive 락이 경합일 때 블록하기 전에 양보해 볼 최대 횟수.
+   0이면 adaptive 락도 곧바로 블록한다. */
+#define LOCK_SPIN_DEFAULT 4
+static unsigned lock_spin_limit = LOCK_SPIN_DEFAULT;
+static struct lock_spin_stats spin_stats;
+
+static bool lock_down (struct lock *, int64_t deadline);
+static void lock_donate (struct lock *);
+static void lock_take (struct lock *);
+
 void
 lock_init (struct lock *lock) {
   ASSERT (lock != NULL);
   lock->holder = NULL;
+  lock->adaptive = false;
   sema_init (&lock->semaphore, 1);
 }
 
+/* 임계 구역이 짧은 락용.  holder가 ready 상태면 블록하는 대신
+   먼저 holder에게 양보해 본다. */
+void
+lock_init_adaptive (struct lock *lock) {
+  lock_init (lock);
+  lock->adaptive = true;
+}
+
+/* 경합 중인 adaptive 락을 블록하지 않고 얻어 본다.
+
+   단일 CPU에서는 holder가 동시에 실행될 수 없으므로 바쁜 대기는
+   의미가 없다.  대신 holder가 ready 상태이고 양보하면 실제로 CPU를
+   받을 우선순위라면 thread_yield()로 holder가 임계 구역을 마치게
+   한다.  holder가 블록됐거나 우선순위가 낮으면 (기부가 필요하므로)
+   바로 포기한다.  락을 얻었으면 true. */
+static bool
+lock_spin (struct lock *lock) {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  unsigned i;
+#ifdef LOCK_PROFILE
+  int64_t wait_start = timer_ticks ();
+#endif
+
+  for (i = 0; i < lock_spin_limit; i++) {
+    struct thread *holder;
+
+    old_level = intr_disable ();
+    holder = lock->holder;
+    if (holder == NULL && lock->semaphore.value > 0) {
+      lock->semaphore.value--;
+      spin_stats.acquired++;
+#ifdef LOCK_PROFILE
+      profile_acquire (&lock->semaphore.profile, true, wait_start);
+#endif
+      lock_take (lock);
+      intr_set_level (old_level);
+      return true;
+    }
+    if (holder == NULL || holder->status != THREAD_READY
+        || holder->priority < cur->priority) {
+      intr_set_level (old_level);
+      break;
+    }
+    spin_stats.yields++;
+    intr_set_level (old_level);
+    thread_yield ();
+  }
+
+  old_level = intr_disable ();
+  spin_stats.blocked++;
+  intr_set_level (old_level);
+  return false;
+}
+
 void
 lock_acquire (struct lock *lock) {
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
-  sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  if (lock->adaptive && lock->holder != NULL && lock_spin (lock))
+    return;
+
+  old_level = intr_disable ();
+  lock_down (lock, INT64_MAX);
+  lock_take (lock);
+  intr_set_level (old_level);
+}
+
+/* LOCK을 얻되, TIMEOUT tick 안에 얻지 못하면 포기한다.  포기할 때는
+   holder에게 했던 우선순위 기부를 거둔다.  얻었으면 true. */
+bool
+lock_acquire_timeout (struct lock *lock, int64_t timeout) {
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (lock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!lock_held_by_current_thread (lock));
+
+  if (lock->adaptive && lock->holder != NULL && lock_spin (lock))
+    return true;
+
+  old_level = intr_disable ();
+  success = lock_down (lock, timer_ticks () + timeout);
+  if (success)
+    lock_take (lock);
+  else if (thread_current ()->waiting_lock != NULL)
+    thread_withdraw_donation ();
+  intr_set_level (old_level);
+
+  return success;
+}
+
+/* LOCK의 세마포어를 내린다.  DEADLINE이 INT64_MAX가 아니면 그
+   tick까지만 기다리고, 그때까지 내리지 못하면 false를 반환한다.
+
+   sema_down()과 달리 잠들 때마다 holder에게 기부한다.  lock_release()가
+   기부를 거두고 깨운 뒤 다른 스레드가 먼저 락을 가져가면 다시
+   기다려야 하는데, 이때 새 holder에게 기부하지 않으면 높은 우선순위의
+   waiter가 낮은 holder 뒤에 갇힌다.  인터럽트가 꺼진 상태에서 호출한다. */
+static bool
+lock_down (struct lock *lock, int64_t deadline) {
+  struct semaphore *sema = &lock->semaphore;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+#ifdef LOCK_PROFILE
+  bool contended = sema->value == 0;
+  int64_t wait_start = timer_ticks ();
+#endif
+  while (sema->value == 0) {
+    if (deadline != INT64_MAX && timer_ticks () >= deadline)
+      return false;
+    lock_donate (lock);
+    waitq_push (&sema->waiters, thread_current ());
+    if (deadline == INT64_MAX)
+      thread_block ();
+    else if (thread_block_timeout (deadline))
+      return false;
+  }
+  sema->value--;
+#ifdef LOCK_PROFILE
+  profile_acquire (&sema->profile, contended, wait_start);
+#endif
+  return true;
+}
+
+/* 현재 스레드가 LOCK을 기다리기 직전에 호출한다.  holder가 있으면
+   기다리는 동안 우선순위를 기부한다 (MLFQS 제외). */
+static void
+lock_donate (struct lock *lock) {
+  struct thread *cur = thread_current ();
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!thread_mlfqs && lock->holder != NULL) {
+    cur->waiting_lock = lock;
+    list_push_back (&lock->holder->donations, &cur->donation_elem);
+    thread_donate_priority ();
+  }
+}
+
+/* LOCK의 세마포어를 내린 뒤 호출한다.  현재 스레드를 holder로 만든다. */
+static void
+lock_take (struct lock *lock) {
+  struct thread *cur = thread_current ();
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  cur->waiting_lock = NULL;
+  lock->holder = cur;
+
+  /* 아직 이 락을 기다리는 스레드들은 이제 새 holder에게 기부한다. */
+  if (!thread_mlfqs) {
+    struct list *heads = &lock->semaphore.waiters.heads;
+    struct list_elem *e, *p;
+    for (e = list_begin (heads); e != list_end (heads); e = list_next (e)) {
+      struct thread *head = list_entry (e, struct thread, elem);
+      list_push_back (&cur->donations, &head->donation_elem);
+      for (p = list_begin (&head->wait_peers); p != list_end (&head->wait_peers);
+           p = list_next (p)) {
+        struct thread *t = list_entry (p, struct thread, elem);
+        list_push_back (&cur->donations, &t->donation_elem);
+      }
+    }
+    thread_refresh_priority ();
+  }
+
+#ifdef LOCK_PROFILE
+  profile_hold (lock);
+#endif
 }
 
+/* LOCK을 기다리지 않고 얻어 본다.  release 직후 깨어난 waiter보다
+   먼저 얻을 수 있으므로, 아직 대기 큐에 남은 스레드들의 기부는
+   lock_take()로 넘겨받는다.  얻었으면 true. */
 bool
 lock_try_acquire (struct lock *lock) {
+  enum intr_level old_level;
+  bool success;
+
   ASSERT (lock != NULL);
   ASSERT (!lock_held_by_current_thread (lock));
 
-  bool success = sema_try_down (&lock->semaphore);
+  old_level = intr_disable ();
+  success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    lock_take (lock);
+  intr_set_level (old_level);
   return success;
 }
 
+/* lock_release()에서 양보만 뺀 것.  인터럽트가 꺼진 상태에서 호출한다. */
+static void
+lock_release_noyield (struct lock *lock) {
+  ASSERT (intr_get_level () == INTR_OFF);
+
+#ifdef LOCK_PROFILE
+  profile_release (lock);
+#endif
+
+  /* 이 락 때문에 받은 기부를 돌려주고 우선순위 복원 */
+  if (!thread_mlfqs) {
+    thread_remove_donations (lock);
+    thread_refresh_priority ();
+  }
+
+  lock->holder = NULL;
+  sema_wake (&lock->semaphore);
+}
+
 void
 lock_release (struct lock *lock) {
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
-  lock->holder = NULL;
-  sema_up (&lock->semaphore); /* 내부에서 즉시 선점 판단 */
+  old_level = intr_disable ();
+  lock_release_noyield (lock);
+  intr_set_level (old_level);
+
+  /* 깨운 waiter가 더 높거나 기부가 끝나 낮아졌다면 양보 */
+  thread_yield_if_preempted ();
 }
 
 bool
@@ -127,72 +598,407 @@ lock_held_by_current_thread (const struct lock *lock) {
   return lock->holder == thread_current ();
 }
 
+/* adaptive 락이 블록하기 전에 양보해 볼 횟수를 LIMIT으로 바꾼다. */
+void
+lock_set_spin_limit (unsigned limit) {
+  lock_spin_limit = limit;
+}
+
+unsigned
+lock_get_spin_limit (void) {
+  return lock_spin_limit;
+}
+
+/* adaptive 락 경합 통계를 STATS에 복사한다. */
+void
+lock_get_spin_stats (struct lock_spin_stats *stats) {
+  enum intr_level old_level = intr_disable ();
+  *stats = spin_stats;
+  intr_set_level (old_level);
+}
+
 /* -------------------- 조건변수 -------------------- */
 
+/* 기다리는 스레드는 cond->waiters에 직접 들어간다.  waiter마다
+   세마포어를 두던 방식과 달리 기다리는 동안 우선순위가 바뀌어도
+   대기 큐가 바로 반영하므로 signal 때 정렬할 필요가 없다. */
+
 void
 cond_init (struct condition *cond) {
   ASSERT (cond != NULL);
-  list_init (&cond->waiters);
+  waitq_init (&cond->waiters);
 }
 
-/* condvar에서 사용할 세마포어 엘리먼트 */
-struct semaphore_elem {
-  struct list_elem elem;      /* cond->waiters에 들어갈 elem */
-  struct semaphore semaphore; /* 각 wait용 세마포어 */
-};
+void
+cond_wait (struct condition *cond, struct lock *lock) {
+  enum intr_level old_level;
+
+  ASSERT (cond != NULL);
+  ASSERT (lock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (lock_held_by_current_thread (lock));
 
-/* semaphore_elem의 최고 우선순위(내부 waiters의 맨 앞 스레드) */
-static int
-semaelem_max_pri (const struct semaphore_elem *se) {
-  if (list_empty (&se->semaphore.waiters)) return PRI_MIN;
-  const struct thread *t = list_entry (list_front (&se->semaphore.waiters), struct thread, elem);
-  return t->priority;
-}
+  /* 큐에 들어가기와 락 놓기 사이에 signal을 놓치지 않도록, 그리고
+     elem이 Ready 큐에 쓰이지 않도록 잠들 때까지 양보하지 않는다. */
+  old_level = intr_disable ();
+  waitq_push (&cond->waiters, thread_current ());
+  lock_release_noyield (lock);
+  thread_block ();
+  intr_set_level (old_level);
 
-/* cond->waiters 정렬용 비교자: 내부 최고 우선순위 큰 게 먼저 */
-static bool
-semaelem_more (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED) {
-  const struct semaphore_elem *sa = list_entry (a, struct semaphore_elem, elem);
-  const struct semaphore_elem *sb = list_entry (b, struct semaphore_elem, elem);
-  return semaelem_max_pri (sa) > semaelem_max_pri (sb);
+  lock_acquire (lock);
 }
 
-void
-cond_wait (struct condition *cond, struct lock *lock) {
-  struct semaphore_elem waiter;
+/* cond_wait()와 같지만 TIMEOUT tick 안에 신호를 받지 못하면 포기한다.
+   어느 쪽이든 LOCK을 다시 잡고 돌아온다.  신호를 받았으면 true. */
+bool
+cond_wait_timeout (struct condition *cond, struct lock *lock, int64_t timeout) {
+  enum intr_level old_level;
+  bool timed_out;
 
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  sema_init (&waiter.semaphore, 0);
+  if (timeout <= 0)
+    return false;
 
-  /* cond->waiters에 priority 기준으로 삽입 */
-  list_insert_ordered (&cond->waiters, &waiter.elem, semaelem_more, NULL);
+  old_level = intr_disable ();
+  waitq_push (&cond->waiters, thread_current ());
+  lock_release_noyield (lock);
+  timed_out = thread_block_timeout (timer_ticks () + timeout);
+  intr_set_level (old_level);
 
-  lock_release (lock);
-  sema_down (&waiter.semaphore);
   lock_acquire (lock);
+  return !timed_out;
 }
 
 void
 cond_signal (struct condition *cond, struct lock *lock UNUSED) {
+  enum intr_level old_level;
+
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
-  if (!list_empty (&cond->waiters)) {
-    /* 내부 최고 우선순위가 가장 높은 waiter부터 깨움 */
-    list_sort (&cond->waiters, semaelem_more, NULL);
-    struct semaphore_elem *se =
-        list_entry (list_pop_front (&cond->waiters), struct semaphore_elem, elem);
-    sema_up (&se->semaphore);  /* 여기서 즉시 선점까지 처리 */
-  }
+  old_level = intr_disable ();
+  if (!waitq_empty (&cond->waiters))
+    thread_unblock (waitq_pop (&cond->waiters));
+  intr_set_level (old_level);
+
+  thread_yield_if_preempted ();
 }
 
 void
 cond_broadcast (struct condition *cond, struct lock *lock) {
-  while (!list_empty (&cond->waiters))
-    cond_signal (cond, lock);
+  enum intr_level old_level;
+
+  ASSERT (cond != NULL);
+  ASSERT (lock != NULL);
+  ASSERT (lock_held_by_current_thread (lock));
+
+  old_level = intr_disable ();
+  waitq_wake_all (&cond->waiters);
+  intr_set_level (old_level);
+
+  thread_yield_if_preempted ();
+}
+
+/* -------------------- Readers-writer 락 -------------------- */
+
+void
+rwlock_init (struct rwlock *rw) {
+  ASSERT (rw != NULL);
+  rw->readers = 0;
+  rw->writer = NULL;
+  waitq_init (&rw->read_waiters);
+  waitq_init (&rw->write_waiters);
+  rw->upgrader = NULL;
+}
+
+/* 인터럽트가 꺼진 상태에서 현재 스레드를 Q에 넣고, 락을 넘겨받을
+   때까지 잔다.  넘겨주는 쪽이 readers/writer를 대신 갱신해 둔다. */
+static void
+rw_wait (struct waitq *q) {
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  waitq_push (q, thread_current ());
+  thread_block ();
+}
+
+/* 락 상태가 바뀐 뒤 기다리는 스레드에게 락을 넘겨준다.
+   rwlock_upgrade() 중인 reader가 마지막 reader가 되면 그 스레드가 가장
+   먼저 쓰기 락을 받는다.  그 외에는 가장 높은 writer보다 우선순위가
+   높은 reader를 모두 깨우고, reader가 남지 않았으면 그 writer를
+   깨운다.  우선순위가 같으면 writer가 먼저다.  깨운 스레드로의
+   양보는 호출자가 인터럽트를 되돌린 뒤 한다. */
+static void
+rw_wake (struct rwlock *rw) {
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (rw->writer != NULL)
+    return;
+
+  if (rw->upgrader != NULL) {
+    if (rw->readers == 1) {
+      rw->readers = 0;
+      rw->writer = rw->upgrader;
+      rw->upgrader = NULL;
+      thread_unblock (rw->writer);
+    }
+    return;
+  }
+
+  while (waitq_max_priority (&rw->read_waiters)
+         > waitq_max_priority (&rw->write_waiters)) {
+    rw->readers++;
+    thread_unblock (waitq_pop (&rw->read_waiters));
+  }
+  if (rw->readers == 0 && !waitq_empty (&rw->write_waiters)) {
+    rw->writer = waitq_pop (&rw->write_waiters);
+    thread_unblock (rw->writer);
+  }
+}
+
+/* 읽기 락을 얻는다.  writer가 잡고 있거나 기다리고 있으면 잔다. */
+void
+rwlock_acquire_read (struct rwlock *rw) {
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  old_level = intr_disable ();
+  if (rw->writer == NULL && waitq_empty (&rw->write_waiters) && rw->upgrader == NULL)
+    rw->readers++;
+  else
+    rw_wait (&rw->read_waiters);
+  intr_set_level (old_level);
+}
+
+/* 기다리지 않고 읽기 락을 얻을 수 있으면 얻고 true를 반환한다. */
+bool
+rwlock_try_acquire_read (struct rwlock *rw) {
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  success = rw->writer == NULL && waitq_empty (&rw->write_waiters) && rw->upgrader == NULL;
+  if (success)
+    rw->readers++;
+  intr_set_level (old_level);
+  return success;
+}
+
+void
+rwlock_release_read (struct rwlock *rw) {
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (rw->readers > 0);
+
+  old_level = intr_disable ();
+  rw->readers--;
+  rw_wake (rw);
+  intr_set_level (old_level);
+
+  thread_yield_if_preempted ();
+}
+
+/* 쓰기 락을 얻는다.  다른 스레드가 어떤 락이든 잡고 있으면 잔다. */
+void
+rwlock_acquire_write (struct rwlock *rw) {
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  old_level = intr_disable ();
+  if (rw->writer == NULL && rw->readers == 0)
+    rw->writer = thread_current ();
+  else
+    rw_wait (&rw->write_waiters);
+  intr_set_level (old_level);
+}
+
+/* 기다리지 않고 쓰기 락을 얻을 수 있으면 얻고 true를 반환한다. */
+bool
+rwlock_try_acquire_write (struct rwlock *rw) {
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  success = rw->writer == NULL && rw->readers == 0;
+  if (success)
+    rw->writer = thread_current ();
+  intr_set_level (old_level);
+  return success;
+}
+
+void
+rwlock_release_write (struct rwlock *rw) {
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_by_current_thread (rw));
+
+  old_level = intr_disable ();
+  rw->writer = NULL;
+  rw_wake (rw);
+  intr_set_level (old_level);
+
+  thread_yield_if_preempted ();
+}
+
+/* 현재 스레드가 잡은 읽기 락을 쓰기 락으로 바꾼다.  다른 reader가
+   모두 놓을 때까지 기다리며, 그동안 기다리던 writer보다 먼저
+   락을 받는다.  다른 스레드가 이미 업그레이드를 기다리고 있으면
+   두 스레드가 서로를 기다리게 되므로 기다리지 않고 false를
+   반환한다.  이 때 읽기 락은 그대로 잡고 있다. */
+bool
+rwlock_upgrade (struct rwlock *rw) {
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->readers > 0);
+
+  old_level = intr_disable ();
+  if (rw->upgrader != NULL) {
+    intr_set_level (old_level);
+    return false;
+  }
+  if (rw->readers == 1) {
+    rw->readers = 0;
+    rw->writer = thread_current ();
+  } else {
+    rw->upgrader = thread_current ();
+    thread_block ();
+  }
+  intr_set_level (old_level);
+  return true;
+}
+
+/* 현재 스레드가 잡은 쓰기 락을 읽기 락으로 바꾼다.  우선순위가
+   가장 높은 writer보다 앞에서 기다리던 reader들도 함께 들어온다. */
+void
+rwlock_downgrade (struct rwlock *rw) {
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_by_current_thread (rw));
+
+  old_level = intr_disable ();
+  rw->writer = NULL;
+  rw->readers = 1;
+  rw_wake (rw);
+  intr_set_level (old_level);
+
+  thread_yield_if_preempted ();
+}
+
+/* 현재 스레드가 쓰기 락을 잡고 있으면 true.  reader는 추적하지
+   않으므로 읽기 락은 확인할 수 없다. */
+bool
+rwlock_held_by_current_thread (const struct rwlock *rw) {
+  ASSERT (rw != NULL);
+  return rw->writer == thread_current ();
+}
+
+/* -------------------- Barrier / Latch -------------------- */
+
+void
+barrier_init (struct barrier *b, unsigned count) {
+  ASSERT (b != NULL);
+  ASSERT (count > 0);
+
+  b->count = count;
+  b->arrived = 0;
+  b->phase = 0;
+  waitq_init (&b->waiters);
+}
+
+/* 이번 단계의 참가자가 모두 도착할 때까지 기다린다.  마지막으로
+   도착한 스레드는 기다리지 않고 나머지를 우선순위 순으로 깨우며,
+   그 스레드만 true를 반환한다 (단계 사이의 정리 작업용).  깨어난
+   스레드가 곧바로 다음 단계에 들어와도 arrived가 이미 0이므로
+   barrier를 계속 다시 쓸 수 있다. */
+bool
+barrier_wait (struct barrier *b) {
+  enum intr_level old_level;
+  bool last;
+
+  ASSERT (b != NULL);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  last = ++b->arrived == b->count;
+  if (last) {
+    b->arrived = 0;
+    b->phase++;
+    waitq_wake_all (&b->waiters);
+  } else {
+    waitq_push (&b->waiters, thread_current ());
+    thread_block ();
+  }
+  intr_set_level (old_level);
+
+  if (last)
+    thread_yield_if_preempted ();
+  return last;
+}
+
+void
+latch_init (struct latch *latch, unsigned count) {
+  ASSERT (latch != NULL);
+
+  latch->count = count;
+  waitq_init (&latch->waiters);
+}
+
+/* 카운트를 하나 줄이고, 0이 되면 기다리는 스레드를 모두 깨운다.
+   블록하지 않으므로 인터럽트 핸들러에서도 부를 수 있다. */
+void
+latch_count_down (struct latch *latch) {
+  enum intr_level old_level;
+
+  ASSERT (latch != NULL);
+
+  old_level = intr_disable ();
+  ASSERT (latch->count > 0);
+  if (--latch->count == 0)
+    waitq_wake_all (&latch->waiters);
+  intr_set_level (old_level);
+
+  thread_yield_if_preempted ();
+}
+
+/* 카운트가 0이 될 때까지 기다린다. */
+void
+latch_wait (struct latch *latch) {
+  enum intr_level old_level;
+
+  ASSERT (latch != NULL);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  if (latch->count > 0) {
+    waitq_push (&latch->waiters, thread_current ());
+    thread_block ();
+  }
+  intr_set_level (old_level);
+}
+
+/* 카운트가 이미 0이면 true. */
+bool
+latch_done (struct latch *latch) {
+  ASSERT (latch != NULL);
+  return latch->count == 0;
 }
@@ -3,17 +3,54 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+
+/* Threads blocked on a synchronization object, highest priority
+   first.  HEADS holds the first waiter of each priority that has
+   any; the rest queue behind it, in FIFO order, on its wait_peers
+   list.  Waking the highest-priority thread is O(1), and queueing
+   a thread only walks the heads, of which there are at most
+   PRI_CNT.  Each blocked thread is in at most one queue. */
+struct waitq
+{
+    struct list heads;   /* One thread per priority, descending. */
+};
+
+void waitq_change_priority (struct thread *, int priority);
+void waitq_cancel (struct thread *);
+
+#ifdef LOCK_PROFILE
+/* Contention statistics for one semaphore or lock.  Kept only in
+   kernels built with LOCK_PROFILE defined ("make LOCK_PROFILE=1");
+   otherwise none of the profiling code or fields exist. */
+struct sync_profile
+{
+    const char *name;             /* Name, or NULL if not registered. */
+    struct list_elem elem;        /* Element in list of named objects. */
+    unsigned long long acquires;  /* Successful downs or acquires. */
+    unsigned long long contended; /* Acquires that had to wait. */
+    int64_t wait_ticks;           /* Total timer ticks spent waiting. */
+    uint64_t hold_start;          /* TSC when the lock was acquired. */
+    uint64_t max_hold;            /* Longest hold in TSC cycles (locks). */
+};
+#endif
 
 /* A counting semaphore. */
 struct semaphore
 {
-    unsigned value;      /* Current value. */
-    struct list waiters; /* List of waiting threads. */
+    unsigned value;         /* Current value. */
+    struct waitq waiters;   /* Waiting threads. */
+#ifdef LOCK_PROFILE
+    struct sync_profile profile;  /* Contention statistics. */
+#endif
 };
 
 void sema_init (struct semaphore *, unsigned value);
 void sema_down (struct semaphore *);
 bool sema_try_down (struct semaphore *);
+bool sema_down_timeout (struct semaphore *, int64_t timeout);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
 
@@ -22,25 +59,106 @@ struct lock
 {
     struct thread *holder;      /* Thread holding lock (for debugging). */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+    bool adaptive;              /* Yield to a ready holder before blocking? */
+};
+
+/* Contended acquires of adaptive locks. */
+struct lock_spin_stats
+{
+    unsigned long long yields;   /* Yields to a ready holder. */
+    unsigned long long acquired; /* Acquired after yielding, without blocking. */
+    unsigned long long blocked;  /* Gave up and blocked. */
 };
 
 void lock_init (struct lock *);
+void lock_init_adaptive (struct lock *);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
+bool lock_acquire_timeout (struct lock *, int64_t timeout);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+void lock_set_spin_limit (unsigned);
+unsigned lock_get_spin_limit (void);
+void lock_get_spin_stats (struct lock_spin_stats *);
+
+/* Reusable barrier.  Each of COUNT participants calls
+   barrier_wait() once per phase; all of them return once the
+   last one arrives. */
+struct barrier
+{
+    unsigned count;         /* Number of participants. */
+    unsigned arrived;       /* Participants waiting in this phase. */
+    unsigned phase;         /* Number of completed phases. */
+    struct waitq waiters;   /* Participants waiting in this phase. */
+};
+
+void barrier_init (struct barrier *, unsigned count);
+bool barrier_wait (struct barrier *);
+
+/* Countdown latch.  Threads that call latch_wait() block until
+   latch_count_down() has been called COUNT times.  Unlike a
+   barrier, a latch is used once and counting down never blocks,
+   so interrupt handlers may count down. */
+struct latch
+{
+    unsigned count;         /* Count downs still to come. */
+    struct waitq waiters;   /* Threads waiting for zero. */
+};
+
+void latch_init (struct latch *, unsigned count);
+void latch_count_down (struct latch *);
+void latch_wait (struct latch *);
+bool latch_done (struct latch *);
+
+/* Contention profiling.  Only semaphores and locks given a name
+   are reported; name an object once, after initializing it, and
+   only if it lives until shutdown. */
+#ifdef LOCK_PROFILE
+void sema_set_name (struct semaphore *, const char *name);
+void lock_set_name (struct lock *, const char *name);
+void lock_profile_enable (size_t top_cnt);
+void lock_profile_print (void);
+#else
+#define sema_set_name(SEMA, NAME) ((void) 0)
+#define lock_set_name(LOCK, NAME) ((void) 0)
+#endif
 
 /* Condition variable. */
 struct condition
 {
-    struct list waiters; /* List of waiting threads. */
+    struct waitq waiters;   /* Waiting threads. */
 };
 
 void cond_init (struct condition *);
 void cond_wait (struct condition *, struct lock *);
+bool cond_wait_timeout (struct condition *, struct lock *, int64_t timeout);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Readers-writer lock.  Any number of readers or a single writer
+   may hold it.  Writers are preferred: once a writer is waiting,
+   new readers wait too.  When the lock is handed off, waiters are
+   served in priority order, highest first. */
+struct rwlock
+{
+    unsigned readers;           /* Number of readers holding the lock. */
+    struct thread *writer;      /* Writer holding the lock, or NULL. */
+    struct waitq read_waiters;  /* Waiting readers. */
+    struct waitq write_waiters; /* Waiting writers. */
+    struct thread *upgrader;    /* Reader waiting in rwlock_upgrade(). */
+};
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+bool rwlock_try_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+bool rwlock_try_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_upgrade (struct rwlock *);
+void rwlock_downgrade (struct rwlock *);
+bool rwlock_held_by_current_thread (const struct rwlock *);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
@@ -4,6 +4,7 @@
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
@@ -11,23 +12,95 @@
 #include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
 
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* 우선순위별 Ready 큐 (FIFO 유지) */
-struct list ready_queues[PRI_MAX + 1];
-int highest_ready_pri;
+/* CPU 하나의 스케줄러 상태 (run queue).
+
+   스레드는 t->cpu가 가리키는 run queue에 들어가고, 각 CPU는 자기
+   run queue에서만 다음 스레드를 고른다.  자기 큐가 비면 다른 CPU의
+   큐에서 스레드를 가져온다 (work stealing, rq_steal() 참고).
+   run queue는 인터럽트를 끈 상태에서만 접근한다.  지금은 부트
+   프로세서 하나만 돌므로 이것으로 충분하며, 여러 CPU를 올리면
+   run queue마다 spinlock을 더해야 한다.
+
+   우선순위별 Ready 큐 (FIFO 유지)의 aging은 큐를 순회하지 않고
+   회전 버킷으로 구현한다.  aging epoch가 하나 증가할 때마다 모든
+   ready 스레드의 우선순위가 1씩 오른 것으로 보며, 이는 우선순위
+   L을 담는 물리 슬롯을 ready_slot(L) = (L - age_epoch) mod 64 로
+   정의해 얻는다.  epoch가 증가하면 각 슬롯은 자동으로 한 단계 위
+   우선순위가 되고, PRI_MAX를 넘어 PRI_MIN으로 넘어가는 슬롯 하나만
+   새 PRI_MAX 슬롯 앞에 splice 하면 된다.  따라서 타이머 인터럽트의
+   aging 비용은 ready 스레드 수와 무관하게 O(1)이다. */
+struct runqueue {
+    struct list ready_queues[PRI_MAX + 1];
+
+    /* 비어 있지 않은 Ready 큐 비트맵: bit p가 1이면 우선순위 p의 큐에
+       스레드가 있음.  물리 슬롯이 아니라 논리 우선순위 기준이며,
+       PRI_MAX + 1 == 64 이므로 64비트 하나로 충분하다. */
+    uint64_t ready_bitmap;
+
+    /* Aging epoch: AGING_INTERVAL tick마다 1 증가. */
+    unsigned age_epoch;
+
+    /* 이 큐에서 실행을 기다리는 스레드 수 (running, idle, 예산을 다
+       쓴 EDF 스레드 제외). */
+    int ready_count;
+
+    /* EDF 스케줄링 클래스 (아래 "EDF" 참고).  edf_ready는 실행 가능한
+       EDF 스레드를 절대 deadline 순으로, edf_throttled는 예산을 다 쓴
+       EDF 스레드를 다음 주기 시작 순으로 담는다. */
+    struct list edf_ready;
+    struct list edf_throttled;
+
+    /* Stride 스케줄링 (아래 "Stride" 참고).  ready 스레드를 pass 값
+       기준 leftist 최소 힙에 담는다.  stride_pass는 마지막으로 실행을
+       시작한 스레드의 pass로, 새로 ready가 된 스레드의 pass는 적어도
+       이 값이 되어 잠든 동안 CPU 몫을 모아 두지 못한다. */
+    struct thread *stride_heap;
+    int64_t stride_pass;
+
+    struct thread *idle_thread;   /* 이 CPU의 idle 스레드. */
+    unsigned thread_ticks;        /* 현재 스레드가 연속으로 쓴 tick. */
+    unsigned steals;              /* 다른 CPU에서 가져온 스레드 수. */
+};
+
+/* CPU별 run queue와 스레드를 나눠 넣을 run queue 수.  부트
+   프로세서만 돌므로 기본값은 1이다.  "-rq" 옵션으로 늘리면 나머지
+   큐의 스레드는 CPU 0이 자기 큐를 비웠을 때 가져와 실행한다
+   (rq_steal()).  AP를 올리기 전에 여러 큐를 다루는 경로를 시험하기
+   위한 것이다. */
+static struct runqueue runqueues[CPU_MAX];
+static unsigned cpu_cnt = 1;
+
+#define AGING_INTERVAL 4
+
+/* 허용된 EDF 스레드들의 대역폭 합 (runtime / deadline,
+   EDF_BW_SCALE 단위). */
+#define EDF_BW_SCALE 1000
+static int edf_total_bw;
 
-/* 전체 스레드 / 슬립 리스트 */
+/* 전체 스레드 리스트 */
 static struct list all_list;
-static struct list sleep_list;
+
+/* 슬립 타이밍 휠 (아래 "Sleep 관리" 참고) / 다음 wakeup tick */
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+
+static struct list sleep_wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static uint64_t sleep_wheel_bitmap[WHEEL_LEVELS];
+
+/* 휠이 마지막으로 처리한 tick. */
+static int64_t wheel_now;
+
 static int64_t next_tick_to_wakeup = INT64_MAX;
 
-/* Idle / Initial */
-static struct thread *idle_thread;
+/* Initial */
 static struct thread *initial_thread;
 
 /* tid lock */
@@ -45,23 +118,81 @@ static long long idle_ticks;
 static long long kernel_ticks;
 static long long user_ticks;
 
+/* 스케줄러 통계.  ready_latency_hist[B]는 READY가 된 뒤 실행되기까지
+   [2**B, 2**(B+1)) TSC 사이클이 걸린 횟수 (B = 0은 0과 1 포함). */
+#define LATENCY_BUCKETS 64
+static unsigned ready_latency_hist[LATENCY_BUCKETS];
+static struct sched_stats exited_stats;
+static int exited_threads;
+bool thread_report_sched;
+
+/* 스레드 페이지 캐시.  종료한 스레드의 페이지를 palloc에 돌려주지
+   않고 최대 thread_cache_size개까지 보관했다가 thread_create()에서
+   다시 쓴다.  인터럽트를 끈 상태에서만 접근한다. */
+static struct thread *thread_cache[THREAD_CACHE_MAX];
+static size_t thread_cache_cnt;
+static size_t thread_cache_size = THREAD_CACHE_DEFAULT;
+static long long thread_cache_hits;
+static long long thread_cache_misses;
+
 /* Scheduling */
 #define TIME_SLICE 4
-static unsigned thread_ticks;
 
 bool thread_mlfqs;
+bool thread_stride;
+bool thread_stack_check;
+
+/* 스택 검사: 새 스택을 채우는 값.  이 값이 남아 있는 워드는 한
+   번도 쓰이지 않은 것으로 본다. */
+#define STACK_FILL 0x57ac57ac
+
+/* Stride: pass 증가량의 기준. */
+#define STRIDE1 (1 << 20)
+
+/* MLFQS: 최근 1분간 실행 가능했던 스레드 수의 지수 이동 평균. */
+static fixed_t load_avg;
+
+/* MLFQS: 우선순위 재계산 주기 (tick). */
+#define MLFQS_PRI_INTERVAL 4
 
 /* 내부 선언 */
 static void kernel_thread (thread_func *, void *aux);
 static void idle (void *aux UNUSED);
 static struct thread *running_thread (void);
-static struct thread *next_thread_to_run (void);
+static struct thread *next_thread_to_run (struct runqueue *);
 static void init_thread (struct thread *, const char *name, int priority);
 static bool is_thread (struct thread *) UNUSED;
 static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static struct runqueue *this_rq (void);
+static struct runqueue *rq_of (const struct thread *);
+static bool is_idle (const struct thread *);
+static struct thread *rq_steal (struct runqueue *);
+static unsigned rq_pick (void);
+static struct list *ready_slot (struct runqueue *, int priority);
+static void ready_push (struct thread *);
+static int ready_highest_pri (struct runqueue *);
+static void ready_remove (struct thread *);
+static int ready_level (const struct thread *);
+static void ready_apply_aging (struct thread *, int level);
+static void thread_change_priority (struct thread *, int priority);
+static void mlfqs_tick (struct thread *);
+static int mlfqs_priority (const struct thread *);
+static void sched_account_switch (struct thread *cur, struct thread *next);
+static void print_sched_stats (void);
+static bool thread_preempted (struct thread *cur);
+static bool edf_preempts (struct thread *cur);
+static void edf_push (struct runqueue *, struct thread *);
+static void edf_tick (struct thread *);
+static void stride_push (struct runqueue *, struct thread *);
+static struct thread *stride_pop (struct runqueue *);
+static struct thread *thread_page_alloc (void);
+static void thread_page_free (struct thread *);
+static void stack_fill (struct thread *, void *top);
+static size_t stack_high_water (const struct thread *);
+static void stack_watch_fault (struct intr_frame *);
 
 /* -------------------- 초기화 -------------------- */
 
@@ -82,19 +213,46 @@ thread_init (void)
 {
     ASSERT (intr_get_level () == INTR_OFF);
 
-    lock_init (&tid_lock);
+    lock_init_adaptive (&tid_lock);
+    lock_set_name (&tid_lock, "tid");
 
-    for (int i = PRI_MIN; i <= PRI_MAX; i++)
-        list_init (&ready_queues[i]);
-    highest_ready_pri = PRI_MIN;
+    for (unsigned c = 0; c < CPU_MAX; c++)
+    {
+        struct runqueue *rq = &runqueues[c];
+
+        for (int i = PRI_MIN; i <= PRI_MAX; i++)
+            list_init (&rq->ready_queues[i]);
+        rq->ready_bitmap = 0;
+        rq->age_epoch = 0;
+        rq->ready_count = 0;
+        list_init (&rq->edf_ready);
+        list_init (&rq->edf_throttled);
+        rq->stride_heap = NULL;
+        rq->stride_pass = 0;
+        rq->idle_thread = NULL;
+        rq->thread_ticks = 0;
+        rq->steals = 0;
+    }
+    load_avg = 0;
 
     list_init (&all_list);
-    list_init (&sleep_list);
+    for (int l = 0; l < WHEEL_LEVELS; l++)
+        for (int i = 0; i < WHEEL_SIZE; i++)
+            list_init (&sleep_wheel[l][i]);
 
     initial_thread = running_thread ();
     init_thread (initial_thread, "main", PRI_DEFAULT);
     initial_thread->status = THREAD_RUNNING;
     initial_thread->tid = allocate_tid ();
+
+    /* main은 이미 스택을 쓰고 있으므로 현재 esp보다 충분히 아래까지만
+       채워 이 함수와 stack_fill()의 프레임을 덮지 않는다. */
+    if (thread_stack_check)
+    {
+        uint8_t *esp;
+        asm ("mov %%esp, %0" : "=g"(esp));
+        stack_fill (initial_thread, esp - 256);
+    }
 }
 
 void
@@ -102,6 +260,15 @@ thread_start (void)
 {
     struct semaphore idle_started;
     sema_init (&idle_started, 0);
+
+    if (thread_stack_check)
+    {
+        intr_register_int (1, 0, INTR_OFF, stack_watch_fault,
+                           "#DB Debug Exception");
+        write_dr0 (&thread_current ()->magic);
+        write_dr7 (DR7_L0 | DR7_LE | DR7_RW0_WRITE | DR7_LEN0_4);
+    }
+
     thread_create ("idle", PRI_MIN, idle, &idle_started);
 
     intr_enable ();
@@ -109,12 +276,31 @@ thread_start (void)
 }
 
 /* -------------------- Tick Handler (에이징 포함) -------------------- */
+static void thread_tick_account (struct thread *);
+
 void
 thread_tick (void)
 {
-    struct thread *t = thread_current ();
+    thread_tick_account (thread_current ());
+
+    /* TIME_SLICE마다 선점 */
+    if (++this_rq ()->thread_ticks >= TIME_SLICE)
+        intr_yield_on_return ();
+}
+
+/* tickless idle 동안 CPU가 쉬며 지나간 tick 하나를 처리한다.
+   타이머 인터럽트가 밀린 tick을 정산할 때 호출한다. */
+void
+thread_tick_idle (void)
+{
+    thread_tick_account (this_rq ()->idle_thread);
+}
 
-    if (t == idle_thread)
+/* T가 CPU를 쓰고 있던 tick 하나에 대한 통계, MLFQS, aging 처리. */
+static void
+thread_tick_account (struct thread *t)
+{
+    if (is_idle (t))
         idle_ticks++;
 #ifdef USERPROG
     else if (t->pagedir != NULL)
@@ -123,33 +309,127 @@ thread_tick (void)
     else
         kernel_ticks++;
 
+    edf_tick (t);
+
+    /* Stride: 실행한 tick마다 stride만큼 pass를 늘린다. */
+    if (thread_stride && !is_idle (t))
+        t->pass += STRIDE1 / t->tickets;
+
+    /* MLFQS는 recent_cpu 감쇠로 starvation을 막으므로 aging 대신 사용 */
+    if (thread_mlfqs)
+        mlfqs_tick (t);
+
     /* --- Aging (starvation 방지) --- */
     static int aging_counter = 0;
-    aging_counter++;
-    if (aging_counter >= 4) {  // 4 tick마다 aging
+    if (!thread_mlfqs && !thread_stride && ++aging_counter >= AGING_INTERVAL) {
         aging_counter = 0;
-        enum intr_level old = intr_disable ();
-        for (int p = PRI_MIN; p <= PRI_MAX; p++) {
-            struct list_elem *e = list_begin(&ready_queues[p]);
-            while (e != list_end(&ready_queues[p])) {
-                struct thread *th = list_entry(e, struct thread, elem);
-                struct list_elem *next = list_next(e);
-
-                if (th->priority < PRI_MAX) {
-                    list_remove(&th->elem);
-                    th->priority++;
-                    list_push_back(&ready_queues[th->priority], &th->elem);
-                    if (th->priority > highest_ready_pri)
-                        highest_ready_pri = th->priority;
-                }
-                e = next;
-            }
-        }
-        intr_set_level (old);
+        thread_aging ();
     }
+}
 
-    /* TIME_SLICE마다 선점 */
-    if (++thread_ticks >= TIME_SLICE)
+/* 모든 ready 스레드의 우선순위를 한 단계 올린다.  큐를 순회하지
+   않고 CPU마다 epoch만 증가시키므로 ready 스레드 수와 무관하다. */
+void
+thread_aging (void)
+{
+    enum intr_level old = intr_disable ();
+
+    for (unsigned c = 0; c < cpu_cnt; c++)
+    {
+        struct runqueue *rq = &runqueues[c];
+        struct list *old_top, *new_top;
+
+        /* epoch 증가 후 PRI_MIN이 될 슬롯은 지금의 PRI_MAX 슬롯이다.
+           이미 PRI_MAX인 스레드는 더 오를 수 없으므로 새 PRI_MAX
+           슬롯(지금의 PRI_MAX - 1) 앞쪽으로 옮겨 FIFO 순서를 지킨다. */
+        old_top = ready_slot (rq, PRI_MAX);
+        new_top = ready_slot (rq, PRI_MAX - 1);
+        if (!list_empty (old_top))
+            list_splice (list_begin (new_top), list_begin (old_top),
+                         list_end (old_top));
+
+        rq->age_epoch++;
+        rq->ready_bitmap = (rq->ready_bitmap << 1)
+                           | (rq->ready_bitmap & ((uint64_t) 1 << PRI_MAX));
+    }
+
+    intr_set_level (old);
+}
+
+/* -------------------- MLFQS -------------------- */
+
+/* priority = PRI_MAX - (recent_cpu / 4) - (nice * 2), [PRI_MIN, PRI_MAX]로 제한. */
+static int
+mlfqs_priority (const struct thread *t)
+{
+    int priority = PRI_MAX - fp_to_int (t->recent_cpu / 4) - t->nice * 2;
+
+    if (priority < PRI_MIN)
+        return PRI_MIN;
+    if (priority > PRI_MAX)
+        return PRI_MAX;
+    return priority;
+}
+
+/* T의 우선순위를 다시 계산하고, ready 상태면 알맞은 큐로 옮긴다. */
+static void
+mlfqs_update_priority (struct thread *t)
+{
+    int priority;
+
+    if (is_idle (t))
+        return;
+
+    priority = mlfqs_priority (t);
+    if (priority != t->priority)
+        thread_change_priority (t, priority);
+}
+
+/* 1초마다 모든 스레드에 대해 호출: recent_cpu 감쇠 후 우선순위 재계산.
+   AUX는 (2*load_avg) / (2*load_avg + 1) 계수를 가리킨다. */
+static void
+mlfqs_decay (struct thread *t, void *coef_)
+{
+    fixed_t *coef = coef_;
+
+    if (is_idle (t))
+        return;
+
+    t->recent_cpu = fp_add_int (fp_mul (*coef, t->recent_cpu), t->nice);
+    mlfqs_update_priority (t);
+}
+
+/* 타이머 인터럽트마다 호출된다.
+
+   recent_cpu는 1초 주기의 감쇠 사이에는 실행 중인 스레드 것만
+   바뀌고, nice는 thread_set_nice()로만 바뀐다.  따라서 4 tick마다
+   우선순위를 다시 계산할 스레드는 CUR 하나뿐이며, all_list 전체를
+   도는 것은 load_avg와 recent_cpu를 갱신하는 1초에 한 번이다. */
+static void
+mlfqs_tick (struct thread *cur)
+{
+    int64_t now = timer_ticks ();
+
+    if (!is_idle (cur))
+        cur->recent_cpu = fp_add_int (cur->recent_cpu, 1);
+
+    if (now % TIMER_FREQ == 0)
+    {
+        int ready = !is_idle (cur) ? 1 : 0;
+        fixed_t twice_load;
+        fixed_t coef;
+
+        for (unsigned c = 0; c < cpu_cnt; c++)
+            ready += runqueues[c].ready_count;
+        load_avg = (load_avg * 59 + fp_from_int (ready)) / 60;
+        twice_load = load_avg * 2;
+        coef = fp_div (twice_load, fp_add_int (twice_load, 1));
+        thread_foreach (mlfqs_decay, &coef);
+    }
+    else if (now % MLFQS_PRI_INTERVAL == 0)
+        mlfqs_update_priority (cur);
+
+    if (thread_preempted (cur))
         intr_yield_on_return ();
 }
 
@@ -159,6 +439,8 @@ thread_print_stats (void)
 {
     printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
             idle_ticks, kernel_ticks, user_ticks);
+    if (thread_report_sched)
+        print_sched_stats ();
 }
 
 /* -------------------- Thread 생성 -------------------- */
@@ -175,15 +457,27 @@ thread_create (const char *name, int priority,
 
     ASSERT (function != NULL);
 
-    t = palloc_get_page (PAL_ZERO);
+    t = thread_page_alloc ();
     if (t == NULL)
         return TID_ERROR;
 
     init_thread (t, name, priority);
     tid = t->tid = allocate_tid ();
 
+    /* MLFQS: nice와 recent_cpu는 부모에게서 물려받는다.
+       우선순위는 ready_push()에서 계산된다. */
+    if (thread_mlfqs)
+    {
+        t->nice = thread_current ()->nice;
+        t->recent_cpu = thread_current ()->recent_cpu;
+    }
+
     old_level = intr_disable ();
 
+    /* idle 스레드는 자기 CPU에 두고, 나머지는 가장 한가한 큐에 넣는다. */
+    if (function != idle)
+        t->cpu = rq_pick ();
+
     kf = alloc_frame (t, sizeof *kf);
     kf->eip = NULL;
     kf->function = function;
@@ -196,12 +490,15 @@ thread_create (const char *name, int priority,
     sf->eip = switch_entry;
     sf->ebp = 0;
 
+    if (thread_stack_check)
+        stack_fill (t, t->stack);
+
     intr_set_level (old_level);
 
     thread_unblock (t);
 
     /* 생성된 스레드가 더 높으면 즉시 양보 */
-    if (t->priority > thread_current()->priority)
+    if (!thread_stride && t->priority > thread_current()->priority)
         thread_yield();
 
     return tid;
@@ -227,20 +524,127 @@ thread_unblock (struct thread *t)
     old_level = intr_disable ();
     ASSERT (t->status == THREAD_BLOCKED);
 
-    list_push_back(&ready_queues[t->priority], &t->elem);
-    if (t->priority > highest_ready_pri)
-        highest_ready_pri = t->priority;
+    uint64_t now = rdtsc ();
+    t->stats.blocked_cycles += now - t->state_since;
+    t->state_since = now;
 
+    ready_push (t);
     t->status = THREAD_READY;
     intr_set_level (old_level);
 }
 
 /* -------------------- Sleep 관리 -------------------- */
+
+/* 잠든 스레드는 계층형 타이밍 휠에 보관한다.
+
+   레벨 L은 WHEEL_SIZE개의 슬롯을 가지며 슬롯 하나가 WHEEL_SIZE**L
+   tick을 담당한다.  wakeup_tick이 wheel_now로부터 WHEEL_SIZE**(L+1)
+   tick 이내인 스레드는 레벨 L 슬롯 (wakeup_tick >> (L * WHEEL_BITS))
+   % WHEEL_SIZE에 들어간다.  wheel_now가 레벨 L 슬롯의 경계에 이르면
+   그 슬롯을 한 단계 아래 레벨로 다시 나눠 넣고 (cascade), 레벨 0
+   슬롯에 남은 스레드는 정확히 그 tick에 깨어난다.
+
+   삽입은 O(1), 깨우기는 깨어나는 스레드 수와 cascade 횟수에
+   비례한다.  레벨마다 비어 있지 않은 슬롯의 비트맵을 두어 다음에
+   처리할 tick을 스레드를 보지 않고 구한다.  자료구조는 파일 앞쪽의
+   sleep_wheel 참고.
+
+   휠은 elem이 아닌 sleep_elem을 쓰므로, 시간 제한이 있는 대기
+   (sema_down_timeout() 등)에서는 스레드가 동기화 객체의 대기 큐와
+   휠에 동시에 들어 있다.  먼저 깨운 쪽이 다른 쪽에서 빼낸다.
+   기한 전에 빼내어 슬롯이 비면 그 비트도 지운다.  남겨 두면
+   wheel_next()가 매 회전마다 빈 슬롯의 tick을 보고하고, tickless
+   idle은 그때마다 헛된 one-shot을 건다. */
+
+/* 레벨 LEVEL의 슬롯 하나가 담당하는 tick 수의 log2. */
+static inline int
+wheel_shift (int level)
+{
+    return level * WHEEL_BITS;
+}
+
+/* 잠든 스레드 T를 휠에 넣는다.  EXTERNAL이면 새로 잠드는 것이므로
+   이미 지난 wakeup_tick은 다음 tick으로 미루고, cascade 중이면 지금
+   처리할 tick에 넣는다.  T가 들어간 슬롯이 처리될 tick을 반환한다. */
+static int64_t
+wheel_insert (struct thread *t, bool external)
+{
+    int64_t earliest = external ? wheel_now + 1 : wheel_now;
+    int64_t expires = t->wakeup_tick;
+    int64_t delta;
+    int level;
+    unsigned idx;
+
+    if (expires < earliest)
+        expires = earliest;
+
+    /* 최상위 레벨보다 먼 스레드는 최상위 레벨에 두고 cascade 때 다시 넣는다. */
+    delta = expires - wheel_now;
+    if (delta >= (int64_t) 1 << wheel_shift (WHEEL_LEVELS))
+        expires = wheel_now + ((int64_t) 1 << wheel_shift (WHEEL_LEVELS)) - 1;
+
+    for (level = 0; level < WHEEL_LEVELS - 1; level++)
+        if (expires - wheel_now < (int64_t) 1 << wheel_shift (level + 1))
+            break;
+
+    idx = (expires >> wheel_shift (level)) & (WHEEL_SIZE - 1);
+    list_push_back (&sleep_wheel[level][idx], &t->sleep_elem);
+    sleep_wheel_bitmap[level] |= (uint64_t) 1 << idx;
+    t->wheel_level = level;
+    t->wheel_idx = idx;
+
+    return level == 0 ? expires
+                      : (expires >> wheel_shift (level)) << wheel_shift (level);
+}
+
+/* 휠이 다음에 처리해야 하는 tick (그 전에는 할 일이 없다).
+   레벨 0에서는 정확한 wakeup tick이고, 상위 레벨에서는 해당 슬롯이
+   cascade 되는 tick이므로 실제 wakeup보다 이를 수 있다. */
+static int64_t
+wheel_next (void)
+{
+    int64_t next = INT64_MAX;
+    int level;
+
+    for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+        uint64_t bits = sleep_wheel_bitmap[level];
+        int64_t cur = wheel_now >> wheel_shift (level);
+        unsigned rot = (cur + 1) & (WHEEL_SIZE - 1);
+        int64_t when;
+
+        if (bits == 0)
+            continue;
+
+        /* 현재 슬롯 다음부터 원형으로 찾아 처음 나오는 슬롯. */
+        if (rot != 0)
+            bits = (bits >> rot) | (bits << (WHEEL_SIZE - rot));
+        when = (cur + 1 + bit_scan_forward64 (bits)) << wheel_shift (level);
+        if (when < next)
+            next = when;
+    }
+    return next;
+}
+
+/* 레벨 LEVEL에서 wheel_now에 해당하는 슬롯을 아래 레벨로 나눠 넣는다. */
 static void
-update_next_tick_to_wakeup (int64_t tick)
+wheel_cascade (int level)
 {
-    next_tick_to_wakeup =
-        (next_tick_to_wakeup > tick) ? tick : next_tick_to_wakeup;
+    unsigned idx = (wheel_now >> wheel_shift (level)) & (WHEEL_SIZE - 1);
+    struct list *slot = &sleep_wheel[level][idx];
+    struct list pending;
+
+    sleep_wheel_bitmap[level] &= ~((uint64_t) 1 << idx);
+    if (list_empty (slot))
+        return;
+
+    list_init (&pending);
+    list_splice (list_end (&pending), list_begin (slot), list_end (slot));
+
+    while (!list_empty (&pending))
+        wheel_insert (list_entry (list_pop_front (&pending), struct thread,
+                                  sleep_elem),
+                      false);
 }
 
 int64_t
@@ -252,41 +656,108 @@ get_next_tick_to_wakeup (void)
 void
 thread_sleep (int64_t tick)
 {
-    struct thread *cur;
-    enum intr_level old_level;
+    enum intr_level old_level = intr_disable ();
 
-    old_level = intr_disable ();
-    cur = thread_current ();
-    ASSERT (cur != idle_thread);
+    ASSERT (!is_idle (thread_current ()));
+
+    thread_block_timeout (tick);
+    intr_set_level (old_level);
+}
+
+/* 현재 스레드를 TICK까지 재운다.  그 전에 다른 스레드가
+   thread_cancel_timeout()을 부르고 깨울 수도 있다.  대기 큐
+   (waitq)에 들어 있는 상태에서 TICK이 되면 그 큐에서도 빼낸다.
+   인터럽트가 꺼진 상태에서 호출해야 하며, 대기 큐에 있었는지와
+   관계없이 TICK이 되어 깨어났으면 true, 그 전에 깨어났으면 false를
+   반환한다. */
+bool
+thread_block_timeout (int64_t tick)
+{
+    struct thread *cur = thread_current ();
+    int64_t when;
 
-    update_next_tick_to_wakeup (cur->wakeup_tick = tick);
-    list_push_back (&sleep_list, &cur->elem);
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    cur->wakeup_tick = tick;
+    cur->timed_out = false;
+    cur->sleeping = true;
+    when = wheel_insert (cur, true);
+    if (when < next_tick_to_wakeup)
+        next_tick_to_wakeup = when;
 
     thread_block ();
-    intr_set_level (old_level);
+    return cur->timed_out;
+}
+
+/* thread_block_timeout()으로 잠든 T를 기한 전에 깨우기 직전에
+   호출한다.  T를 sleep wheel에서 빼고, 슬롯이 비면 그 비트를 지워
+   다음 wakeup tick을 다시 구한다. */
+void
+thread_cancel_timeout (struct thread *t)
+{
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    if (t->sleeping)
+    {
+        list_remove (&t->sleep_elem);
+        t->sleeping = false;
+        if (list_empty (&sleep_wheel[t->wheel_level][t->wheel_idx]))
+        {
+            sleep_wheel_bitmap[t->wheel_level] &= ~((uint64_t) 1 << t->wheel_idx);
+            next_tick_to_wakeup = wheel_next ();
+        }
+    }
 }
 
 void
 thread_wakeup (int64_t current_tick)
 {
-    struct list_elem *e;
-    next_tick_to_wakeup = INT64_MAX;
+    ASSERT (intr_get_level () == INTR_OFF);
 
-    e = list_begin (&sleep_list);
-    while (e != list_end (&sleep_list))
+    /* 할 일이 있는 tick으로만 건너뛰며 처리한다. */
+    while (wheel_now < current_tick)
     {
-        struct thread *t = list_entry (e, struct thread, elem);
-        if (current_tick >= t->wakeup_tick)
+        int64_t next = wheel_next ();
+        struct list *slot;
+        int level;
+
+        if (next > current_tick)
         {
-            e = list_remove (&t->elem);
-            thread_unblock (t);
+            wheel_now = current_tick;
+            break;
         }
-        else
+        wheel_now = next;
+
+        /* 하위 비트가 모두 0인 레벨들을 위에서부터 cascade. */
+        if ((wheel_now & (WHEEL_SIZE - 1)) == 0)
         {
-            e = list_next (e);
-            update_next_tick_to_wakeup (t->wakeup_tick);
+            int top = 1;
+            while (top < WHEEL_LEVELS - 1
+                   && ((wheel_now >> wheel_shift (top)) & (WHEEL_SIZE - 1)) == 0)
+                top++;
+            for (level = top; level >= 1; level--)
+                wheel_cascade (level);
+        }
+
+        slot = &sleep_wheel[0][wheel_now & (WHEEL_SIZE - 1)];
+        sleep_wheel_bitmap[0] &= ~((uint64_t) 1 << (wheel_now & (WHEEL_SIZE - 1)));
+        while (!list_empty (slot))
+        {
+            struct thread *t = list_entry (list_pop_front (slot), struct thread,
+                                           sleep_elem);
+            t->sleeping = false;
+            t->timed_out = true;
+            if (t->waitq != NULL)
+                waitq_cancel (t);
+            thread_unblock (t);
         }
     }
+
+    next_tick_to_wakeup = wheel_next ();
+
+    /* 깨어난 EDF 스레드는 다음 time slice를 기다리지 않는다. */
+    if (edf_preempts (thread_current ()))
+        intr_yield_on_return ();
 }
 
 /* -------------------- 기본 Thread 정보 -------------------- */
@@ -321,7 +792,13 @@ thread_exit (void)
     process_exit ();
 #endif
 
+    if (thread_stack_check)
+        printf ("%s: stack high-water mark %zu of %zu bytes\n",
+                thread_name (), stack_high_water (thread_current ()),
+                PGSIZE - sizeof (struct thread));
+
     intr_disable ();
+    edf_total_bw -= thread_current ()->dl_bw;
     list_remove (&thread_current ()->allelem);
     thread_current ()->status = THREAD_DYING;
     schedule ();
@@ -337,12 +814,8 @@ thread_yield (void)
     ASSERT (!intr_context ());
 
     old_level = intr_disable ();
-    if (cur != idle_thread)
-    {
-        list_push_back(&ready_queues[cur->priority], &cur->elem);
-        if (cur->priority > highest_ready_pri)
-            highest_ready_pri = cur->priority;
-    }
+    if (!is_idle (cur))
+        ready_push (cur);
     cur->status = THREAD_READY;
     schedule ();
     intr_set_level (old_level);
@@ -352,159 +825,1116 @@ thread_yield (void)
 void
 thread_set_priority (int new_priority)
 {
-    enum intr_level old = intr_disable ();
-    int oldp = thread_current()->priority;
-    thread_current()->priority = new_priority;
+    /* MLFQS에서는 스케줄러가 우선순위를 직접 관리한다. */
+    if (thread_mlfqs)
+        return;
 
-    if (new_priority < oldp)
-    {
-        for (int p = PRI_MAX; p > new_priority; p--)
-        {
-            if (!list_empty(&ready_queues[p]))
-            {
-                intr_set_level (old);
-                thread_yield();
-                return;
-            }
-        }
-    }
+    enum intr_level old = intr_disable ();
+    /* 기부받은 우선순위는 유지하고 기본 우선순위만 바꾼다. */
+    thread_current ()->base_priority = new_priority;
+    thread_refresh_priority ();
     intr_set_level (old);
+
+    thread_yield_if_preempted ();
 }
 
-int
-thread_get_priority (void)
+/* 현재 스레드보다 높은 우선순위의 ready 스레드가 있으면 양보한다.
+   인터럽트 컨텍스트에서는 핸들러가 끝난 뒤 양보한다. */
+void
+thread_yield_if_preempted (void)
 {
-    return thread_current ()->priority;
+    enum intr_level old = intr_disable ();
+    bool preempted = thread_preempted (thread_current ());
+    intr_set_level (old);
+
+    if (!preempted)
+        return;
+    if (intr_context ())
+        intr_yield_on_return ();
+    else
+        thread_yield ();
 }
 
-/* -------------------- Nice/CPU 미사용 -------------------- */
-void thread_set_nice (int nice UNUSED) {}
-int thread_get_nice (void) { return 0; }
-int thread_get_load_avg (void) { return 0; }
-int thread_get_recent_cpu (void) { return 0; }
+/* -------------------- Priority donation -------------------- */
 
-/* -------------------- Idle Thread -------------------- */
-static void
-idle (void *idle_started_ UNUSED)
+/* T의 실제 우선순위.  우선순위 클래스의 ready 스레드는 큐에서
+   기다리는 동안 쌓인 aging이 priority에 아직 반영되지 않았으므로
+   지금 속한 큐의 우선순위를 쓴다.  이보다 낮게 기부하면
+   thread_change_priority()가 T를 오히려 낮은 큐로 옮긴다. */
+static int
+effective_priority (const struct thread *t)
 {
-    struct semaphore *idle_started = idle_started_;
-    idle_thread = thread_current ();
-    sema_up (idle_started);
+    if (t->status == THREAD_READY && t->dl_period == 0 && !thread_stride)
+        return ready_level (t);
+    return t->priority;
+}
 
-    for (;;)
+/* 현재 스레드가 waiting_lock을 기다리기 시작할 때 호출한다.
+   lock holder를 따라가며 최대 DONATION_DEPTH_MAX 단계까지
+   우선순위를 기부한다 (nested donation). */
+void
+thread_donate_priority (void)
+{
+    struct thread *t = thread_current ();
+    int depth;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    for (depth = 0; depth < DONATION_DEPTH_MAX && t->waiting_lock != NULL;
+         depth++)
     {
-        intr_disable ();
-        thread_block ();
-        asm volatile ("sti; hlt" : : : "memory");
+        struct thread *holder = t->waiting_lock->holder;
+
+        if (holder == NULL || effective_priority (holder) >= t->priority)
+            break;
+        thread_change_priority (holder, t->priority);
+        t = holder;
     }
 }
 
-/* -------------------- 내부 유틸 -------------------- */
-static void
-kernel_thread (thread_func *function, void *aux)
+/* LOCK을 해제하기 전에 호출한다.  LOCK을 기다리며 현재 스레드에
+   우선순위를 기부하던 스레드들을 donations 목록에서 뺀다. */
+void
+thread_remove_donations (struct lock *lock)
 {
-    ASSERT (function != NULL);
-    intr_enable ();
-    function (aux);
-    thread_exit ();
-}
+    struct list *donations = &thread_current ()->donations;
+    struct list_elem *e;
 
-struct thread *
-running_thread (void)
-{
-    uint32_t *esp;
-    asm ("mov %%esp, %0" : "=g"(esp));
-    return pg_round_down (esp);
-}
+    ASSERT (intr_get_level () == INTR_OFF);
 
-static bool
-is_thread (struct thread *t)
-{
-    return t != NULL && t->magic == THREAD_MAGIC;
+    for (e = list_begin (donations); e != list_end (donations);)
+    {
+        struct thread *t = list_entry (e, struct thread, donation_elem);
+        if (t->waiting_lock == lock)
+            e = list_remove (e);
+        else
+            e = list_next (e);
+    }
 }
 
-static void
-init_thread (struct thread *t, const char *name, int priority)
+/* T의 기본 우선순위와 남은 기부자(multiple donation) 중 가장 높은 값. */
+static int
+donated_priority (struct thread *t)
 {
-    ASSERT (t != NULL);
-    ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
-    ASSERT (name != NULL);
+    struct list_elem *e;
+    int priority = t->base_priority;
 
-    memset (t, 0, sizeof *t);
-    t->status = THREAD_BLOCKED;
-    strlcpy (t->name, name, sizeof t->name);
-    t->stack = (uint8_t *)t + PGSIZE;
-    t->priority = priority;
-    t->magic = THREAD_MAGIC;
-    list_push_back (&all_list, &t->allelem);
+    for (e = list_begin (&t->donations); e != list_end (&t->donations);
+         e = list_next (e))
+    {
+        struct thread *d = list_entry (e, struct thread, donation_elem);
+        if (d->priority > priority)
+            priority = d->priority;
+    }
+    return priority;
 }
 
-static void *
-alloc_frame (struct thread *t, size_t size)
+/* 현재 스레드의 우선순위를 기본 우선순위와 남은 기부자 중 가장
+   높은 값으로 다시 계산한다. */
+void
+thread_refresh_priority (void)
 {
-    ASSERT (is_thread (t));
-    ASSERT (size % sizeof (uint32_t) == 0);
-    t->stack -= size;
-    return t->stack;
+    struct thread *cur = thread_current ();
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    cur->priority = donated_priority (cur);
 }
 
-static struct thread *
-next_thread_to_run (void)
+/* 현재 스레드가 waiting_lock을 기다리다 시간 초과로 포기할 때
+   호출한다.  holder의 donations에서 빠지고, 기부 사슬을 따라
+   올라가며 우선순위를 다시 계산한다.  락이 holder 사이에서 넘어가는
+   중이면 어느 donations에도 들어 있지 않다. */
+void
+thread_withdraw_donation (void)
 {
-    for (int p = highest_ready_pri; p >= PRI_MIN; p--)
-    {
-        if (!list_empty(&ready_queues[p]))
+    struct thread *cur = thread_current ();
+    struct lock *lock = cur->waiting_lock;
+    struct thread *holder = lock->holder;
+    struct list_elem *e;
+    int depth;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    cur->waiting_lock = NULL;
+    if (holder == NULL)
+        return;
+
+    for (e = list_begin (&holder->donations); e != list_end (&holder->donations);
+         e = list_next (e))
+        if (e == &cur->donation_elem)
         {
-            struct list_elem *e = list_pop_front(&ready_queues[p]);
-            if (list_empty(&ready_queues[p]))
-            {
-                int new_high = p - 1;
-                while (new_high >= PRI_MIN && list_empty(&ready_queues[new_high]))
-                    new_high--;
-                highest_ready_pri = (new_high < PRI_MIN) ? PRI_MIN : new_high;
-            }
-            return list_entry(e, struct thread, elem);
+            list_remove (e);
+            break;
         }
+
+    for (depth = 0; depth < DONATION_DEPTH_MAX && holder != NULL; depth++)
+    {
+        int priority = donated_priority (holder);
+
+        if (priority == holder->priority)
+            break;
+        thread_change_priority (holder, priority);
+        holder = holder->waiting_lock != NULL ? holder->waiting_lock->holder
+                                              : NULL;
     }
-    return idle_thread;
 }
 
-/* -------------------- 스케줄러 -------------------- */
-void
-thread_schedule_tail (struct thread *prev)
+/* T의 우선순위를 PRIORITY로 바꾼다.  T가 ready 상태면 해당
+   우선순위의 Ready 큐로, 동기화 객체를 기다리는 중이면 그 대기
+   큐의 새 위치로 옮긴다. */
+static void
+thread_change_priority (struct thread *t, int priority)
 {
-    struct thread *cur = running_thread ();
     ASSERT (intr_get_level () == INTR_OFF);
-    cur->status = THREAD_RUNNING;
-    thread_ticks = 0;
-
-#ifdef USERPROG
-    process_activate ();
-#endif
 
-    if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread)
+    /* Stride 모드에서는 우선순위가 실행 순서에 영향을 주지 않는다. */
+    if (t->status == THREAD_READY && !thread_stride)
     {
-        ASSERT (prev != cur);
-        palloc_free_page (prev);
+        ready_remove (t);
+        t->priority = priority;
+        ready_push (t);
     }
+    else if (t->status == THREAD_BLOCKED && t->waitq != NULL)
+        waitq_change_priority (t, priority);
+    else
+        t->priority = priority;
 }
 
-static void
-schedule (void)
+int
+thread_get_priority (void)
 {
-    struct thread *cur = running_thread ();
-    struct thread *next = next_thread_to_run ();
-    struct thread *prev = NULL;
+    return thread_current ()->priority;
+}
 
-    ASSERT (intr_get_level () == INTR_OFF);
-    ASSERT (cur->status != THREAD_RUNNING);
+/* -------------------- EDF -------------------- */
+
+/* EDF 스레드는 주기 (period)마다 최대 runtime tick을 쓰며, 각 주기
+   시작부터 deadline tick 안에 일을 끝내야 한다.  ready EDF 스레드는
+   우선순위와 상관없이 우선순위 클래스보다 먼저, 절대 deadline이
+   이른 순서로 실행된다.
+
+   thread_set_deadline()은 runtime / deadline의 합이 EDF_BW_MAX를
+   넘지 않는 경우에만 허용하므로 (admission control), 허용된 스레드가
+   선언한 runtime만 쓰면 모두 deadline을 지킬 수 있고 우선순위
+   스레드에게도 최소 (EDF_BW_SCALE - EDF_BW_MAX) / EDF_BW_SCALE의
+   CPU가 남는다.  runtime을 다 쓴 스레드는 다음 주기까지 실행되지
+   않으므로 (throttling), 선언보다 오래 도는 스레드는 자신의
+   deadline만 놓친다.
+
+   이 때 절대 deadline (dl_abs_deadline)은 스케줄링 순서에 쓰이고,
+   작업이 끝났는지 판정하는 deadline (dl_job_deadline)은
+   thread_wait_next_period()로 다음 작업을 시작할 때만 바뀐다. */
+
+/* T의 새 주기를 START에 시작한다. */
+static void
+edf_new_period (struct thread *t, int64_t start)
+{
+    t->dl_period_start = start;
+    t->dl_abs_deadline = start + t->dl_deadline;
+    t->dl_budget = t->dl_runtime;
+    t->dl_throttled = false;
+}
+
+static bool
+edf_deadline_less (const struct list_elem *a_, const struct list_elem *b_,
+                   void *aux UNUSED)
+{
+    const struct thread *a = list_entry (a_, struct thread, elem);
+    const struct thread *b = list_entry (b_, struct thread, elem);
+    return a->dl_abs_deadline < b->dl_abs_deadline;
+}
+
+static bool
+edf_replenish_less (const struct list_elem *a_, const struct list_elem *b_,
+                    void *aux UNUSED)
+{
+    const struct thread *a = list_entry (a_, struct thread, elem);
+    const struct thread *b = list_entry (b_, struct thread, elem);
+    return a->dl_period_start + a->dl_period
+           < b->dl_period_start + b->dl_period;
+}
+
+/* ready가 된 EDF 스레드 T를 RQ의 edf_ready에, 예산을 다 썼으면
+   edf_throttled에 넣는다.  deadline이 지난 채 다시 ready가 되면
+   지금부터 새 주기를 시작한다.  edf_throttled의 스레드는 실행할 수
+   없으므로 ready_count에 세지 않고, 예산을 채워 edf_ready로 옮길 때
+   센다. */
+static void
+edf_push (struct runqueue *rq, struct thread *t)
+{
+    if (t->dl_throttled)
+    {
+        list_insert_ordered (&rq->edf_throttled, &t->elem,
+                             edf_replenish_less, NULL);
+        return;
+    }
+    if (timer_ticks () >= t->dl_abs_deadline)
+        edf_new_period (t, timer_ticks ());
+    list_insert_ordered (&rq->edf_ready, &t->elem, edf_deadline_less, NULL);
+    rq->ready_count++;
+}
+
+/* CUR보다 먼저 실행되어야 할 EDF 스레드가 ready인가. */
+static bool
+edf_preempts (struct thread *cur)
+{
+    struct runqueue *rq = this_rq ();
+    struct thread *t;
+
+    if (list_empty (&rq->edf_ready))
+        return false;
+    t = list_entry (list_front (&rq->edf_ready), struct thread, elem);
+    return cur->dl_period == 0 || cur->dl_throttled
+           || t->dl_abs_deadline < cur->dl_abs_deadline;
+}
+
+/* CUR보다 먼저 실행되어야 할 ready 스레드가 있는가. */
+static bool
+thread_preempted (struct thread *cur)
+{
+    if (edf_preempts (cur))
+        return true;
+    if (cur->dl_period != 0 && !cur->dl_throttled)
+        return false;
+    return ready_highest_pri (this_rq ()) > cur->priority;
+}
+
+/* 타이머 tick마다 호출된다.  T가 EDF 스레드면 예산을 차감하고,
+   다 썼으면 다음 주기까지 쉬게 한다.  이 CPU에서 주기가 돌아온
+   스레드는 예산을 채워 다시 ready로 만든다. */
+static void
+edf_tick (struct thread *t)
+{
+    struct runqueue *rq = this_rq ();
+    int64_t now = timer_ticks ();
+
+    if (t->dl_period != 0 && !t->dl_throttled && --t->dl_budget <= 0)
+    {
+        t->dl_throttled = true;
+        intr_yield_on_return ();
+    }
+
+    while (!list_empty (&rq->edf_throttled))
+    {
+        struct thread *r = list_entry (list_front (&rq->edf_throttled),
+                                       struct thread, elem);
+        if (r->dl_period_start + r->dl_period > now)
+            break;
+        list_pop_front (&rq->edf_throttled);
+        edf_new_period (r, r->dl_period_start + r->dl_period);
+        list_insert_ordered (&rq->edf_ready, &r->elem, edf_deadline_less,
+                             NULL);
+        rq->ready_count++;
+    }
+
+    if (edf_preempts (t))
+        intr_yield_on_return ();
+}
+
+/* 현재 스레드를 EDF 클래스로 옮긴다.  지금부터 PERIOD tick마다
+   RUNTIME tick까지 CPU를 받고, 각 주기 시작 후 DEADLINE tick 안에
+   작업을 끝내야 한다.  DEADLINE이 0이면 PERIOD와 같다.
+   0 < RUNTIME <= DEADLINE <= PERIOD 이어야 한다.
+
+   허용하면 EDF 스레드 전체의 대역폭이 EDF_BW_MAX를 넘는 경우
+   아무것도 바꾸지 않고 false를 반환한다.  이미 EDF 스레드면 매개
+   변수를 바꾼다. */
+bool
+thread_set_deadline (int64_t runtime, int64_t period, int64_t deadline)
+{
+    struct thread *cur = thread_current ();
+    enum intr_level old_level;
+    int bw;
+
+    if (deadline == 0)
+        deadline = period;
+    ASSERT (0 < runtime && runtime <= deadline && deadline <= period);
+
+    bw = DIV_ROUND_UP (runtime * EDF_BW_SCALE, deadline);
+
+    old_level = intr_disable ();
+    if (edf_total_bw - cur->dl_bw + bw > EDF_BW_MAX)
+    {
+        intr_set_level (old_level);
+        return false;
+    }
+    edf_total_bw += bw - cur->dl_bw;
+    cur->dl_bw = bw;
+    cur->dl_runtime = runtime;
+    cur->dl_period = period;
+    cur->dl_deadline = deadline;
+    cur->dl_jobs = cur->dl_misses = 0;
+    edf_new_period (cur, timer_ticks ());
+    cur->dl_job_deadline = cur->dl_abs_deadline;
+    intr_set_level (old_level);
+
+    return true;
+}
+
+/* 현재 스레드를 EDF 클래스에서 빼 우선순위 클래스로 돌려보낸다. */
+void
+thread_clear_deadline (void)
+{
+    struct thread *cur = thread_current ();
+    enum intr_level old_level = intr_disable ();
+
+    edf_total_bw -= cur->dl_bw;
+    cur->dl_bw = 0;
+    cur->dl_period = 0;
+    cur->dl_throttled = false;
+    intr_set_level (old_level);
+
+    thread_yield_if_preempted ();
+}
+
+/* EDF 스레드가 이번 주기의 작업을 끝냈을 때 호출한다.  deadline을
+   넘겼으면 miss로 센 뒤, 다음 주기가 시작될 때까지 잔다.  이미
+   다음 주기를 넘겼으면 지금부터 새 주기를 시작한다. */
+void
+thread_wait_next_period (void)
+{
+    struct thread *cur = thread_current ();
+    enum intr_level old_level = intr_disable ();
+    int64_t now = timer_ticks ();
+    int64_t next = cur->dl_period_start + cur->dl_period;
+
+    ASSERT (cur->dl_period != 0);
+
+    cur->dl_jobs++;
+    if (now > cur->dl_job_deadline)
+        cur->dl_misses++;
+
+    if (next < now)
+        next = now;
+    edf_new_period (cur, next);
+    cur->dl_job_deadline = cur->dl_abs_deadline;
+
+    if (next > now)
+        thread_sleep (next);
+    else
+        thread_yield ();
+    intr_set_level (old_level);
+}
+
+/* 현재 EDF 스레드가 끝낸 작업 수와 그 중 deadline을 놓친 수. */
+void
+thread_get_deadline_stats (unsigned *jobs, unsigned *misses)
+{
+    *jobs = thread_current ()->dl_jobs;
+    *misses = thread_current ()->dl_misses;
+}
+
+/* -------------------- Stride -------------------- */
+
+/* "-stride" 옵션을 주면 우선순위 대신 stride 스케줄링을 쓴다.
+   스레드는 티켓 수에 반비례하는 stride (STRIDE1 / tickets)를 가지며,
+   실행한 tick마다 pass가 stride만큼 늘어난다.  스케줄러는 항상 pass가
+   가장 작은 스레드를 고르므로 CPU 시간이 티켓 수에 비례해 나뉘고,
+   우선순위가 낮아 굶는 스레드가 없다.  EDF 스레드는 여전히 먼저
+   실행된다. */
+
+static int
+stride_rank (const struct thread *t)
+{
+    return t != NULL ? t->heap_rank : 0;
+}
+
+/* A가 B보다 먼저 실행되어야 하는가.  pass가 같으면 tid 순. */
+static bool
+stride_less (const struct thread *a, const struct thread *b)
+{
+    return a->pass != b->pass ? a->pass < b->pass : a->tid < b->tid;
+}
+
+/* leftist 힙 A와 B를 합친다.  오른쪽 경로 길이가 O(log n)이므로
+   재귀 깊이도 O(log n)이다. */
+static struct thread *
+stride_merge (struct thread *a, struct thread *b)
+{
+    struct thread *tmp;
+
+    if (a == NULL)
+        return b;
+    if (b == NULL)
+        return a;
+    if (stride_less (b, a))
+    {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+    a->heap_right = stride_merge (a->heap_right, b);
+    if (stride_rank (a->heap_left) < stride_rank (a->heap_right))
+    {
+        tmp = a->heap_left;
+        a->heap_left = a->heap_right;
+        a->heap_right = tmp;
+    }
+    a->heap_rank = stride_rank (a->heap_right) + 1;
+    return a;
+}
+
+/* T를 RQ의 힙에 넣는다.  잠들었다 깨어난 스레드의 pass는 적어도
+   stride_pass가 되게 한다. */
+static void
+stride_push (struct runqueue *rq, struct thread *t)
+{
+    if (t->pass < rq->stride_pass)
+        t->pass = rq->stride_pass;
+    t->heap_left = t->heap_right = NULL;
+    t->heap_rank = 1;
+    rq->stride_heap = stride_merge (rq->stride_heap, t);
+}
+
+/* pass가 가장 작은 스레드를 RQ의 힙에서 꺼낸다.  힙이 비어 있으면
+   안 된다. */
+static struct thread *
+stride_pop (struct runqueue *rq)
+{
+    struct thread *t = rq->stride_heap;
+
+    rq->stride_heap = stride_merge (t->heap_left, t->heap_right);
+    rq->stride_pass = t->pass;
+    return t;
+}
+
+/* 현재 스레드의 티켓 수를 TICKETS로 바꾼다. */
+void
+thread_set_tickets (int tickets)
+{
+    ASSERT (TICKETS_MIN <= tickets && tickets <= TICKETS_MAX);
+    thread_current ()->tickets = tickets;
+}
+
+/* 현재 스레드의 티켓 수. */
+int
+thread_get_tickets (void)
+{
+    return thread_current ()->tickets;
+}
+
+/* -------------------- Nice/CPU (MLFQS) -------------------- */
+void
+thread_set_nice (int nice)
+{
+    struct thread *cur = thread_current ();
+    enum intr_level old;
+
+    ASSERT (NICE_MIN <= nice && nice <= NICE_MAX);
+
+    old = intr_disable ();
+    cur->nice = nice;
+    if (thread_mlfqs)
+    {
+        cur->priority = mlfqs_priority (cur);
+        if (thread_preempted (cur))
+        {
+            intr_set_level (old);
+            thread_yield ();
+            return;
+        }
+    }
+    intr_set_level (old);
+}
+
+int
+thread_get_nice (void)
+{
+    return thread_current ()->nice;
+}
+
+/* load_avg의 100배를 반올림해 반환한다. */
+int
+thread_get_load_avg (void)
+{
+    enum intr_level old = intr_disable ();
+    int load = fp_round (load_avg * 100);
+    intr_set_level (old);
+    return load;
+}
+
+/* 현재 스레드 recent_cpu의 100배를 반올림해 반환한다. */
+int
+thread_get_recent_cpu (void)
+{
+    enum intr_level old = intr_disable ();
+    int recent = fp_round (thread_current ()->recent_cpu * 100);
+    intr_set_level (old);
+    return recent;
+}
+
+/* -------------------- Idle Thread -------------------- */
+static void
+idle (void *idle_started_ UNUSED)
+{
+    struct semaphore *idle_started = idle_started_;
+    this_rq ()->idle_thread = thread_current ();
+    sema_up (idle_started);
+
+    for (;;)
+    {
+        intr_disable ();
+        thread_block ();
+
+        /* tickless 모드면 다음 wakeup까지 주기적 tick을 멈춘다. */
+        timer_idle_enter ();
+        asm volatile ("sti; hlt" : : : "memory");
+    }
+}
+
+/* -------------------- 내부 유틸 -------------------- */
+static void
+kernel_thread (thread_func *function, void *aux)
+{
+    ASSERT (function != NULL);
+    intr_enable ();
+    function (aux);
+    thread_exit ();
+}
+
+struct thread *
+running_thread (void)
+{
+    uint32_t *esp;
+    asm ("mov %%esp, %0" : "=g"(esp));
+    return pg_round_down (esp);
+}
+
+static bool
+is_thread (struct thread *t)
+{
+    return t != NULL && t->magic == THREAD_MAGIC;
+}
+
+static void
+init_thread (struct thread *t, const char *name, int priority)
+{
+    ASSERT (t != NULL);
+    ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+    ASSERT (name != NULL);
+
+    memset (t, 0, sizeof *t);
+    t->status = THREAD_BLOCKED;
+    strlcpy (t->name, name, sizeof t->name);
+    t->stack = (uint8_t *)t + PGSIZE;
+    t->priority = priority;
+    t->base_priority = priority;
+    t->tickets = TICKETS_DEFAULT;
+    t->cpu = cpu_id ();
+    list_init (&t->donations);
+    t->state_since = rdtsc ();
+    t->magic = THREAD_MAGIC;
+    list_push_back (&all_list, &t->allelem);
+}
+
+static void *
+alloc_frame (struct thread *t, size_t size)
+{
+    ASSERT (is_thread (t));
+    ASSERT (size % sizeof (uint32_t) == 0);
+    t->stack -= size;
+    return t->stack;
+}
+
+/* 현재 CPU의 run queue. */
+static struct runqueue *
+this_rq (void)
+{
+    return &runqueues[cpu_id ()];
+}
+
+/* T가 속한 run queue. */
+static struct runqueue *
+rq_of (const struct thread *t)
+{
+    return &runqueues[t->cpu];
+}
+
+/* T가 자기 CPU의 idle 스레드인가. */
+static bool
+is_idle (const struct thread *t)
+{
+    return t == rq_of (t)->idle_thread;
+}
+
+/* RQ의 현재 aging epoch에서 우선순위 PRIORITY의 스레드를 담는
+   Ready 큐. */
+static struct list *
+ready_slot (struct runqueue *rq, int priority)
+{
+    return &rq->ready_queues[(priority - rq->age_epoch) & PRI_MAX];
+}
+
+/* T를 자기 run queue의 우선순위 Ready 큐 맨 뒤에 넣고 비트맵을
+   갱신한다.  큐에 들어간 epoch를 기록해 두었다가 꺼낼 때 aging을
+   반영한다. */
+static void
+ready_push (struct thread *t)
+{
+    struct runqueue *rq = rq_of (t);
+
+    /* MLFQS: 큐에 들어갈 때마다 최신 recent_cpu로 우선순위를 맞춘다. */
+    if (thread_mlfqs && !is_idle (t))
+        t->priority = mlfqs_priority (t);
+
+    if (t->dl_period != 0)
+    {
+        edf_push (rq, t);
+        return;
+    }
+    rq->ready_count++;
+    if (thread_stride)
+    {
+        stride_push (rq, t);
+        return;
+    }
+    t->age = rq->age_epoch;
+    list_push_back (ready_slot (rq, t->priority), &t->elem);
+    rq->ready_bitmap |= (uint64_t) 1 << t->priority;
+}
+
+/* 현재 aging epoch에서 ready 스레드 T가 속한 우선순위. */
+static int
+ready_level (const struct thread *t)
+{
+    unsigned aged = rq_of (t)->age_epoch - t->age;
+
+    if (aged >= (unsigned) (PRI_MAX - t->priority))
+        return PRI_MAX;
+    return t->priority + aged;
+}
+
+/* ready 스레드 T를 Ready 큐에서 뺀다. 큐가 비면 비트맵도 갱신한다.
+   T에게 쌓인 aging은 우선순위에 반영한다. */
+static void
+ready_remove (struct thread *t)
+{
+    struct runqueue *rq = rq_of (t);
+    int level;
+
+    ASSERT (t->status == THREAD_READY);
+
+    if (t->dl_period != 0)
+    {
+        list_remove (&t->elem);
+        if (!t->dl_throttled)
+            rq->ready_count--;
+        return;
+    }
+
+    level = ready_level (t);
+    list_remove (&t->elem);
+    if (list_empty (ready_slot (rq, level)))
+        rq->ready_bitmap &= ~((uint64_t) 1 << level);
+    rq->ready_count--;
+    ready_apply_aging (t, level);
+}
+
+/* ready 큐에서 나온 T에게 기다리는 동안 쌓인 aging을 반영한다.
+   LEVEL은 T가 있던 큐의 우선순위다.  aging은 기본 우선순위도
+   같은 만큼 올리므로 기부가 끝난 뒤에도 유지된다. */
+static void
+ready_apply_aging (struct thread *t, int level)
+{
+    int aged = level - t->priority;
+
+    if (aged <= 0)
+        return;
+    t->priority = level;
+    t->base_priority = t->base_priority + aged < PRI_MAX
+                           ? t->base_priority + aged : PRI_MAX;
+}
+
+/* RQ의 비어 있지 않은 Ready 큐 중 가장 높은 우선순위, 모두
+   비었으면 -1. */
+static int
+ready_highest_pri (struct runqueue *rq)
+{
+    uint32_t hi = rq->ready_bitmap >> 32;
+    uint32_t lo = rq->ready_bitmap;
+
+    if (hi != 0)
+        return 32 + bit_scan_reverse (hi);
+    if (lo != 0)
+        return bit_scan_reverse (lo);
+    return -1;
+}
+
+/* RQ가 비었을 때, ready 스레드가 가장 많은 다른 CPU의 큐에서
+   스레드 하나를 가져와 RQ의 CPU로 옮긴다.  우선순위 클래스에서는
+   그 큐의 가장 높은 우선순위 스레드를, stride 모드에서는 pass가
+   가장 작은 스레드를 가져온다.  EDF 스레드는 admission control이
+   CPU마다 이루어진다고 보고 옮기지 않는다.  가져올 스레드가 없으면
+   RQ의 idle 스레드를 반환한다. */
+static struct thread *
+rq_steal (struct runqueue *rq)
+{
+    struct runqueue *victim = NULL;
+    struct thread *t;
+
+    for (unsigned c = 0; c < cpu_cnt; c++)
+    {
+        struct runqueue *r = &runqueues[c];
+
+        if (r == rq || r->ready_count <= 0)
+            continue;
+        if (thread_stride ? r->stride_heap == NULL
+                          : ready_highest_pri (r) < 0)
+            continue;
+        if (victim == NULL || r->ready_count > victim->ready_count)
+            victim = r;
+    }
+    if (victim == NULL)
+        return rq->idle_thread;
+
+    if (thread_stride)
+    {
+        t = stride_pop (victim);
+        victim->ready_count--;
+    }
+    else
+    {
+        int p = ready_highest_pri (victim);
+        t = list_entry (list_front (ready_slot (victim, p)),
+                        struct thread, elem);
+        ready_remove (t);
+    }
+    t->cpu = rq - runqueues;
+    rq->steals++;
+    return t;
+}
+
+/* 새 스레드를 넣을 run queue: ready 스레드가 가장 적은 큐. */
+static unsigned
+rq_pick (void)
+{
+    unsigned best = 0;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    for (unsigned c = 1; c < cpu_cnt; c++)
+        if (runqueues[c].ready_count < runqueues[best].ready_count)
+            best = c;
+    return best;
+}
+
+/* 스레드를 나눠 넣을 run queue 수를 CNT로 바꾼다 (1 이상 CPU_MAX
+   이하).  스레드를 만들기 전, 명령줄 옵션을 읽을 때 호출한다. */
+void
+thread_set_runqueue_cnt (unsigned cnt)
+{
+    if (cnt < 1 || cnt > CPU_MAX)
+        PANIC ("run queue count must be between 1 and %d", CPU_MAX);
+    cpu_cnt = cnt;
+}
+
+/* RQ에서 다음에 실행할 스레드를 고른다. */
+static struct thread *
+next_thread_to_run (struct runqueue *rq)
+{
+    int p = ready_highest_pri (rq);
+    struct list_elem *e;
+    struct thread *t;
+
+    /* EDF 스레드가 우선순위 클래스보다 먼저 실행된다. */
+    if (!list_empty (&rq->edf_ready))
+    {
+        rq->ready_count--;
+        return list_entry (list_pop_front (&rq->edf_ready),
+                           struct thread, elem);
+    }
+
+    if (thread_stride)
+    {
+        if (rq->stride_heap == NULL)
+            return rq_steal (rq);
+        rq->ready_count--;
+        return stride_pop (rq);
+    }
+
+    if (p < 0)
+        return rq_steal (rq);
+
+    e = list_pop_front (ready_slot (rq, p));
+    rq->ready_count--;
+    if (list_empty (ready_slot (rq, p)))
+        rq->ready_bitmap &= ~((uint64_t) 1 << p);
+
+    t = list_entry (e, struct thread, elem);
+    ready_apply_aging (t, p);
+    return t;
+}
+
+/* -------------------- 스케줄러 -------------------- */
+void
+thread_schedule_tail (struct thread *prev)
+{
+    struct thread *cur = running_thread ();
+    ASSERT (intr_get_level () == INTR_OFF);
+    cur->status = THREAD_RUNNING;
+    this_rq ()->thread_ticks = 0;
+
+    /* 스택 검사: 감시점을 새로 실행할 스레드의 magic으로 옮긴다. */
+    if (thread_stack_check)
+        write_dr0 (&cur->magic);
+
+#ifdef USERPROG
+    process_activate ();
+#endif
+
+    if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread)
+    {
+        ASSERT (prev != cur);
+        thread_page_free (prev);
+    }
+}
+
+/* -------------------- 스택 검사 -------------------- */
+
+/* "-stack-check" 옵션을 주면 커널 스택 사용량을 검사한다.
+
+   스택은 struct thread와 같은 페이지에 있어 넘치면 바로 아래의
+   struct thread를 덮는다.  페이지 끝의 magic이 가장 먼저 덮이므로
+   실행 중인 스레드의 magic에 디버그 레지스터 쓰기 감시점을 걸어,
+   넘치는 첫 쓰기에서 #DB로 멈춘다.  나중에 is_thread()가 깨진
+   magic을 발견하는 것보다 원인에 훨씬 가깝다.
+
+   또 스레드를 만들 때 스택의 빈 부분을 STACK_FILL로 채워 두고,
+   종료할 때 바닥부터 처음으로 값이 바뀐 워드를 찾아 가장 깊이
+   쓴 양 (high-water mark)을 보고한다. */
+
+/* T의 스택 바닥 (struct thread 바로 위)부터 TOP 직전까지를
+   STACK_FILL로 채운다. */
+static void
+stack_fill (struct thread *t, void *top)
+{
+    uint32_t *p;
+
+    for (p = (uint32_t *) (t + 1); (void *) p < top; p++)
+        *p = STACK_FILL;
+}
+
+/* T의 스택 중 지금까지 가장 깊이 쓴 바이트 수. */
+static size_t
+stack_high_water (const struct thread *t)
+{
+    const uint32_t *p = (const uint32_t *) (t + 1);
+    const uint8_t *top = (const uint8_t *) t + PGSIZE;
+
+    while ((const uint8_t *) p < top && *p == STACK_FILL)
+        p++;
+    return top - (const uint8_t *) p;
+}
+
+/* #DB 처리기.  감시점이 걸린 것이면 스택이 넘친 것이다.  이
+   시점에는 magic과 그 바로 아래만 덮였으므로 이름은 아직 읽을 수
+   있다.  처리기는 넘친 스택 위에서 돌고 PANIC의 출력이 그 아래를
+   더 덮으므로, 이름은 먼저 복사해 둔다.  다른 원인의 #DB는
+   무시한다. */
+static void
+stack_watch_fault (struct intr_frame *f)
+{
+    static char name[sizeof ((struct thread *) 0)->name];
+    uint32_t dr6 = read_dr6 ();
+
+    write_dr6 (0);
+    if (dr6 & DR6_B0)
+    {
+        strlcpy (name, running_thread ()->name, sizeof name);
+        PANIC ("kernel stack overflow in thread \"%s\" at %p",
+               name, (void *) f->eip);
+    }
+}
+
+/* -------------------- 스레드 페이지 캐시 -------------------- */
+
+/* 새 스레드가 쓸 페이지를 캐시에서 꺼내거나 palloc에서 받는다.
+   init_thread()가 struct thread를, alloc_frame()이 첫 문맥 전환에
+   필요한 프레임을 다시 쓰므로 페이지 전체를 0으로 채우지 않는다.
+   나머지는 스택으로 쓰일 뿐이라 이전 내용이 남아 있어도 된다. */
+static struct thread *
+thread_page_alloc (void)
+{
+    struct thread *t = NULL;
+    enum intr_level old_level = intr_disable ();
+
+    if (thread_cache_cnt > 0)
+    {
+        t = thread_cache[--thread_cache_cnt];
+        thread_cache_hits++;
+    }
+    else
+        thread_cache_misses++;
+    intr_set_level (old_level);
+
+    if (t == NULL)
+        t = palloc_get_page (0);
+    return t;
+}
+
+/* 종료한 스레드 T의 페이지를 캐시에 넣고, 캐시가 차 있으면 palloc에
+   돌려준다.  magic을 지워 해제된 스레드를 is_thread()가 거부하게 한다. */
+static void
+thread_page_free (struct thread *t)
+{
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    t->magic = 0;
+    if (thread_cache_cnt < thread_cache_size)
+        thread_cache[thread_cache_cnt++] = t;
+    else
+        palloc_free_page (t);
+}
+
+/* 캐시에 보관할 스레드 페이지 수를 SIZE로 바꾼다 (최대
+   THREAD_CACHE_MAX).  0이면 캐시를 쓰지 않는다. */
+void
+thread_set_page_cache_size (size_t size)
+{
+    enum intr_level old_level = intr_disable ();
+
+    thread_cache_size = size < THREAD_CACHE_MAX ? size : THREAD_CACHE_MAX;
+    while (thread_cache_cnt > thread_cache_size)
+        palloc_free_page (thread_cache[--thread_cache_cnt]);
+    intr_set_level (old_level);
+}
+
+/* 캐시에 보관할 스레드 페이지 수. */
+size_t
+thread_get_page_cache_size (void)
+{
+    return thread_cache_size;
+}
+
+static void
+schedule (void)
+{
+    struct thread *cur = running_thread ();
+    struct thread *next = next_thread_to_run (this_rq ());
+    struct thread *prev = NULL;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+    ASSERT (cur->status != THREAD_RUNNING);
     ASSERT (is_thread (next));
 
+    /* idle이 CPU를 내주면 tickless one-shot을 정리하고 주기적 tick으로 */
+    if (is_idle (cur) && !is_idle (next))
+        timer_idle_exit ();
+
     if (cur != next)
+    {
+        sched_account_switch (cur, next);
         prev = switch_threads (cur, next);
+    }
     thread_schedule_tail (prev);
 }
 
+/* -------------------- 스케줄러 통계 -------------------- */
+
+/* CUR에서 NEXT로 전환할 때 두 스레드의 통계를 갱신한다.
+   문맥 전환마다 rdtsc 한 번과 덧셈 몇 개만 든다. */
+static void
+sched_account_switch (struct thread *cur, struct thread *next)
+{
+    uint64_t now = rdtsc ();
+    uint64_t latency = now - next->state_since;
+
+    cur->stats.run_cycles += now - cur->state_since;
+    cur->state_since = now;
+    if (cur->status == THREAD_READY)
+        cur->stats.involuntary++;
+    else
+        cur->stats.voluntary++;
+
+    /* idle은 ready 큐를 거치지 않으므로 지연 통계에서 뺀다. */
+    if (!is_idle (next))
+    {
+        uint32_t hi = latency >> 32;
+        int bucket = hi != 0 ? 32 + bit_scan_reverse (hi)
+                   : latency > 1 ? bit_scan_reverse (latency) : 0;
+        next->stats.ready_cycles += latency;
+        ready_latency_hist[bucket]++;
+    }
+    next->state_since = now;
+
+    if (cur->status == THREAD_DYING)
+    {
+        exited_stats.run_cycles += cur->stats.run_cycles;
+        exited_stats.ready_cycles += cur->stats.ready_cycles;
+        exited_stats.blocked_cycles += cur->stats.blocked_cycles;
+        exited_stats.voluntary += cur->stats.voluntary;
+        exited_stats.involuntary += cur->stats.involuntary;
+        exited_threads++;
+    }
+}
+
+/* 스레드 하나의 통계를 한 줄로 출력한다. */
+static void
+print_sched_line (const char *name, const struct sched_stats *s)
+{
+    printf ("  %-16s %12llu %12llu %12llu %8u %8u\n", name,
+            s->run_cycles / 1000, s->ready_cycles / 1000,
+            s->blocked_cycles / 1000, s->voluntary, s->involuntary);
+}
+
+/* 살아 있는 스레드별 통계, 종료한 스레드의 합계, 준비 → 실행 지연
+   히스토그램을 출력한다. */
+static void
+print_sched_stats (void)
+{
+    enum intr_level old_level = intr_disable ();
+    struct thread *cur = thread_current ();
+    struct lock_spin_stats spin;
+    unsigned max_cnt = 0;
+    struct list_elem *e;
+    char label[32];
+    int b;
+
+    /* 실행 중인 스레드의 현재 구간까지 반영한다. */
+    uint64_t now = rdtsc ();
+    cur->stats.run_cycles += now - cur->state_since;
+    cur->state_since = now;
+
+    printf ("Scheduler: times in thousands of TSC cycles\n");
+    printf ("  %-16s %12s %12s %12s %8s %8s\n",
+            "thread", "run", "ready", "blocked", "vol", "invol");
+    for (e = list_begin (&all_list); e != list_end (&all_list);
+         e = list_next (e))
+    {
+        struct thread *t = list_entry (e, struct thread, allelem);
+        snprintf (label, sizeof label, "%d %s", t->tid, t->name);
+        print_sched_line (label, &t->stats);
+    }
+    snprintf (label, sizeof label, "%d exited", exited_threads);
+    print_sched_line (label, &exited_stats);
+    printf ("Thread page cache: %lld hits, %lld misses, %zu of %zu cached\n",
+            thread_cache_hits, thread_cache_misses,
+            thread_cache_cnt, thread_cache_size);
+    for (unsigned c = 0; c < cpu_cnt; c++)
+        printf ("Run queue %u: %d ready, %u stolen\n",
+                c, runqueues[c].ready_count, runqueues[c].steals);
+    lock_get_spin_stats (&spin);
+    printf ("Adaptive locks: %llu yields, %llu acquired without blocking, "
+            "%llu blocked\n", spin.yields, spin.acquired, spin.blocked);
+
+    printf ("Ready latency in TSC cycles:\n");
+    for (b = 0; b < LATENCY_BUCKETS; b++)
+        if (ready_latency_hist[b] > max_cnt)
+            max_cnt = ready_latency_hist[b];
+    for (b = 0; b < LATENCY_BUCKETS; b++)
+        if (ready_latency_hist[b] != 0)
+        {
+            int stars = (ready_latency_hist[b] * 40ULL + max_cnt - 1) / max_cnt;
+            printf ("  >= %20llu %8u ", b == 0 ? 0ULL : 1ULL << b,
+                    ready_latency_hist[b]);
+            while (stars-- > 0)
+                putchar ('*');
+            putchar ('\n');
+        }
+    intr_set_level (old_level);
+}
+
 static tid_t
 allocate_tid (void)
 {
@@ -3,7 +3,9 @@
 
 #include <debug.h>
 #include <list.h>
+#include <stddef.h>
 #include <stdint.h>
+#include "threads/fixed-point.h"
 
 /* States in a thread's life cycle. */
 enum thread_status
@@ -14,6 +16,32 @@ enum thread_status
     THREAD_DYING    /* About to be destroyed. */
 };
 
+/* Scheduler accounting for one thread.  Times are in TSC
+   cycles. */
+struct sched_stats
+{
+    uint64_t run_cycles;     /* Time spent RUNNING. */
+    uint64_t ready_cycles;   /* Time spent READY. */
+    uint64_t blocked_cycles; /* Time spent BLOCKED. */
+    unsigned voluntary;      /* Switches away by blocking or exiting. */
+    unsigned involuntary;    /* Switches away while still runnable. */
+};
+
+/* Stride scheduling tickets. */
+#define TICKETS_MIN 1          /* Smallest share. */
+#define TICKETS_DEFAULT 100    /* Default share. */
+#define TICKETS_MAX 10000      /* Largest share. */
+
+/* Largest total bandwidth, in thousandths of the CPU, that
+   thread_set_deadline() admits for EDF threads.  The rest is left
+   for threads in the priority class. */
+#define EDF_BW_MAX 900
+
+/* Number of freed thread pages kept for reuse by
+   thread_create(), by default and at most. */
+#define THREAD_CACHE_DEFAULT 8
+#define THREAD_CACHE_MAX 64
+
 /* Thread identifier type.
    You can redefine this to whatever type you like. */
 typedef int tid_t;
@@ -24,6 +52,20 @@ typedef int tid_t;
 #define PRI_DEFAULT 31 /* Default priority. */
 #define PRI_MAX 63     /* Highest priority. */
 
+/* Thread niceness for the MLFQS scheduler. */
+#define NICE_MIN -20   /* Nicest to other threads. */
+#define NICE_DEFAULT 0 /* Default niceness. */
+#define NICE_MAX 20    /* Least nice. */
+
+/* Maximum length of a priority donation chain followed by
+   lock_acquire().  Deeper chains are cut off at this many
+   holders, which bounds the time spent with interrupts off. */
+#ifndef DONATION_DEPTH_MAX
+#define DONATION_DEPTH_MAX 8
+#endif
+
+struct lock;
+
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -76,7 +118,7 @@ typedef int tid_t;
    value, triggering the assertion. */
 /* The `elem' member has a dual purpose.  It can be an element in
    the run queue (thread.c), or it can be an element in a
-   semaphore wait list (synch.c).  It can be used these two ways
+   semaphore wait queue (synch.c).  It can be used these two ways
    only because they are mutually exclusive: only a thread in the
    ready state is on the run queue, whereas only a thread in the
    blocked state is on a semaphore wait list. */
@@ -92,11 +134,56 @@ struct thread
     
     // [추가] Sleep/Wakeup 및 Aging 구현에 필요한 멤버
     int64_t wakeup_tick;       /* When to wake up this thread. */
-    int age;                   /* [추가] Aging: time spent in ready queue. */
+    struct list_elem sleep_elem; /* Element in the sleep wheel. */
+    bool sleeping;             /* In the sleep wheel? */
+    int wheel_level;           /* Sleep wheel level, if sleeping. */
+    unsigned wheel_idx;        /* Slot within WHEEL_LEVEL. */
+    bool timed_out;            /* Woken by its deadline? */
+    unsigned age;              /* [추가] Aging: epoch when queued as ready. */
+    unsigned cpu;              /* [추가] CPU whose run queue we belong to. */
+
+    // [추가] MLFQS (4.4BSD) 스케줄러 상태
+    int nice;                  /* Niceness, NICE_MIN to NICE_MAX. */
+    fixed_t recent_cpu;        /* Recent CPU use, 17.14 fixed point. */
+
+    // [추가] Priority donation
+    int base_priority;              /* Priority before donations. */
+    struct lock *waiting_lock;      /* Lock being waited for, or NULL. */
+    struct list donations;          /* Threads donating priority to us. */
+    struct list_elem donation_elem; /* Element in a holder's donations. */
+
+    // [추가] EDF 스케줄링 클래스 (dl_period가 0이면 우선순위 클래스)
+    int64_t dl_runtime;        /* CPU budget per period, in ticks. */
+    int64_t dl_period;         /* Period, in ticks. */
+    int64_t dl_deadline;       /* Deadline relative to period start. */
+    int64_t dl_period_start;   /* Start of current period. */
+    int64_t dl_abs_deadline;   /* Scheduling deadline. */
+    int64_t dl_job_deadline;   /* Deadline of current job. */
+    int64_t dl_budget;         /* Budget left in current period. */
+    bool dl_throttled;         /* Out of budget until next period? */
+    int dl_bw;                 /* Admitted bandwidth. */
+    unsigned dl_jobs;          /* Jobs completed. */
+    unsigned dl_misses;        /* Jobs completed after their deadline. */
+
+    // [추가] Stride 스케줄링
+    int tickets;               /* Share of the CPU, relative to others. */
+    int64_t pass;              /* Virtual time; lowest runs next. */
+    struct thread *heap_left;  /* Children in the ready heap. */
+    struct thread *heap_right;
+    int heap_rank;             /* Length of the heap's right spine. */
+
+    // [추가] 스케줄러 통계
+    struct sched_stats stats;  /* CPU and queueing time. */
+    uint64_t state_since;      /* TSC when status last changed. */
 
     /* Shared between thread.c and synch.c. */
     struct list_elem elem; /* List element. */
 
+    /* Owned by synch.c. */
+    struct waitq *waitq;        /* Queue blocked on, or NULL. */
+    bool wait_head;             /* First of its priority in WAITQ? */
+    struct list wait_peers;     /* If so, same-priority waiters behind it. */
+
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir; /* Page directory. */
@@ -111,13 +198,35 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use stride scheduling: threads get CPU time in
+   proportion to their tickets, regardless of priority.
+   Controlled by kernel command-line option "-stride". */
+extern bool thread_stride;
+
+/* If true, check kernel stack use.  New stacks are filled with a
+   pattern so that each thread's high-water mark can be reported
+   when it exits, and a debug-register watchpoint on the running
+   thread's magic number panics on the first write that overflows
+   its stack into struct thread.
+   Controlled by kernel command-line option "-stack-check". */
+extern bool thread_stack_check;
+
+/* If true, thread_print_stats() also prints per-thread CPU
+   accounting and a histogram of ready-to-run latency.
+   Controlled by kernel command-line action "schedstats". */
+extern bool thread_report_sched;
+
 void thread_init (void);
 void thread_start (void);
 
-void thread_aging(void); // [추가] Aging 함수 선언
+void thread_aging (void); // [추가] Aging 함수 선언
 
 void thread_tick (void);
+void thread_tick_idle (void);
 void thread_print_stats (void);
+void thread_set_page_cache_size (size_t);
+size_t thread_get_page_cache_size (void);
+void thread_set_runqueue_cnt (unsigned);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
@@ -138,6 +247,21 @@ void thread_foreach (thread_action_func *, void *);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
+void thread_yield_if_preempted (void);
+
+bool thread_set_deadline (int64_t runtime, int64_t period, int64_t deadline);
+void thread_clear_deadline (void);
+void thread_wait_next_period (void);
+void thread_get_deadline_stats (unsigned *jobs, unsigned *misses);
+
+void thread_set_tickets (int);
+int thread_get_tickets (void);
+
+// [추가] Priority donation (synch.c의 lock에서 사용)
+void thread_donate_priority (void);
+void thread_remove_donations (struct lock *);
+void thread_refresh_priority (void);
+void thread_withdraw_donation (void);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
@@ -147,6 +271,8 @@ int thread_get_load_avg (void);
 // [추가] Timer-based Sleep/Wakeup 함수 선언
 void thread_wakeup(int64_t current_tick);
 void thread_sleep(int64_t tick);
+bool thread_block_timeout (int64_t tick);
+void thread_cancel_timeout (struct thread *);
 int64_t get_next_tick_to_wakeup(void);
 
 #endif /* threads/thread.h */
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/cpu.h"
+#include "threads/malloc.h"
+
+/* Maximum number of items a worker takes off the queue at once. */
+#define WORK_BATCH 8
+
+/* A queued function call. */
+struct work_item
+{
+    struct list_elem elem;      /* In a priority queue or free list. */
+    work_func *func;            /* Function to call. */
+    void *aux;                  /* Argument to FUNC. */
+    int priority;               /* Priority to run at. */
+};
+
+static thread_func worker;
+
+/* Initializes WQ and starts WORKER_CNT worker threads at
+   PRIORITY, which is also the priority of items submitted with
+   workqueue_submit().  NAME is used to name the workers.
+   Returns true if successful, false if a worker could not be
+   created, in which case WQ is left unusable. */
+bool
+workqueue_init (struct workqueue *wq, const char *name,
+                int worker_cnt, int priority)
+{
+    int i;
+
+    ASSERT (wq != NULL);
+    ASSERT (worker_cnt > 0);
+    ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+    strlcpy (wq->name, name, sizeof wq->name);
+    wq->priority = priority;
+    lock_init (&wq->lock);
+    cond_init (&wq->work_ready);
+    cond_init (&wq->idle);
+    for (i = PRI_MIN; i <= PRI_MAX; i++)
+        list_init (&wq->queues[i]);
+    wq->nonempty = 0;
+    wq->pending = 0;
+    list_init (&wq->free_items);
+    wq->worker_cnt = 0;
+    wq->stopping = false;
+    sema_init (&wq->workers_done, 0);
+
+    for (i = 0; i < worker_cnt; i++)
+        {
+            char thread_name[16];
+
+            snprintf (thread_name, sizeof thread_name, "%s/%d", name, i);
+            if (thread_create (thread_name, priority, worker, wq) == TID_ERROR)
+                {
+                    workqueue_destroy (wq);
+                    return false;
+                }
+            wq->worker_cnt++;
+        }
+    return true;
+}
+
+/* Queues FUNC(AUX) to run on one of WQ's workers at WQ's default
+   priority.  Returns true if successful, false if out of
+   memory. */
+bool
+workqueue_submit (struct workqueue *wq, work_func *func, void *aux)
+{
+    return workqueue_submit_pri (wq, func, aux, wq->priority);
+}
+
+/* Queues FUNC(AUX) to run on one of WQ's workers at PRIORITY.
+   Returns true if successful, false if out of memory. */
+bool
+workqueue_submit_pri (struct workqueue *wq, work_func *func, void *aux,
+                      int priority)
+{
+    struct work_item *item;
+
+    ASSERT (func != NULL);
+    ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+    lock_acquire (&wq->lock);
+    ASSERT (!wq->stopping);
+    if (!list_empty (&wq->free_items))
+        item = list_entry (list_pop_front (&wq->free_items),
+                           struct work_item, elem);
+    else
+        {
+            /* Don't hold the lock across malloc(). */
+            lock_release (&wq->lock);
+            item = malloc (sizeof *item);
+            if (item == NULL)
+                return false;
+            lock_acquire (&wq->lock);
+        }
+
+    item->func = func;
+    item->aux = aux;
+    item->priority = priority;
+    list_push_back (&wq->queues[priority], &item->elem);
+    wq->nonempty |= (uint64_t) 1 << priority;
+    wq->pending++;
+    cond_signal (&wq->work_ready, &wq->lock);
+    lock_release (&wq->lock);
+
+    return true;
+}
+
+/* Waits until WQ has no work queued or running.  Must not be
+   called from one of WQ's own workers. */
+void
+workqueue_flush (struct workqueue *wq)
+{
+    lock_acquire (&wq->lock);
+    while (wq->pending > 0)
+        cond_wait (&wq->idle, &wq->lock);
+    lock_release (&wq->lock);
+}
+
+/* Runs the work remaining in WQ, stops its workers, and frees
+   its resources.  No work may be submitted to WQ afterward. */
+void
+workqueue_destroy (struct workqueue *wq)
+{
+    int i;
+
+    lock_acquire (&wq->lock);
+    wq->stopping = true;
+    cond_broadcast (&wq->work_ready, &wq->lock);
+    lock_release (&wq->lock);
+
+    for (i = 0; i < wq->worker_cnt; i++)
+        sema_down (&wq->workers_done);
+
+    while (!list_empty (&wq->free_items))
+        free (list_entry (list_pop_front (&wq->free_items),
+                          struct work_item, elem));
+}
+
+/* Worker thread.  Takes up to WORK_BATCH of the highest-priority
+   items off the queue at a time and runs them without holding
+   the lock, until the queue is stopped and empty. */
+static void
+worker (void *wq_)
+{
+    struct workqueue *wq = wq_;
+    struct list batch;
+
+    list_init (&batch);
+
+    lock_acquire (&wq->lock);
+    for (;;)
+        {
+            struct list_elem *e;
+            size_t cnt;
+
+            while (wq->nonempty == 0 && !wq->stopping)
+                cond_wait (&wq->work_ready, &wq->lock);
+            if (wq->nonempty == 0)
+                break;
+
+            for (cnt = 0; cnt < WORK_BATCH && wq->nonempty != 0; cnt++)
+                {
+                    int pri = bit_scan_reverse64 (wq->nonempty);
+                    struct list *queue = &wq->queues[pri];
+
+                    list_push_back (&batch, list_pop_front (queue));
+                    if (list_empty (queue))
+                        wq->nonempty &= ~((uint64_t) 1 << pri);
+                }
+            lock_release (&wq->lock);
+
+            for (e = list_begin (&batch); e != list_end (&batch);
+                 e = list_next (e))
+                {
+                    struct work_item *item = list_entry (e, struct work_item,
+                                                         elem);
+                    if (!thread_mlfqs
+                        && item->priority != thread_current ()->base_priority)
+                        thread_set_priority (item->priority);
+                    item->func (item->aux);
+                }
+            if (!thread_mlfqs && thread_current ()->base_priority != wq->priority)
+                thread_set_priority (wq->priority);
+
+            lock_acquire (&wq->lock);
+            list_splice (list_begin (&wq->free_items),
+                         list_begin (&batch), list_end (&batch));
+            wq->pending -= cnt;
+            if (wq->pending == 0)
+                cond_broadcast (&wq->idle, &wq->lock);
+        }
+    lock_release (&wq->lock);
+
+    sema_up (&wq->workers_done);
+}
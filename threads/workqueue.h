@@ -0,0 +1,48 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* A work queue runs short functions asynchronously on a fixed
+   pool of kernel threads.  Submitting work costs a list insertion
+   instead of the page allocation and stack setup of
+   thread_create(), and a worker that wakes up runs a batch of
+   queued items before going back to sleep.
+
+   Items run in order of priority, highest first, and FIFO within
+   a priority.  A worker runs each item at the item's priority. */
+
+/* A function run by a work queue. */
+typedef void work_func (void *aux);
+
+/* A pool of worker threads and the work queued for them. */
+struct workqueue
+{
+    char name[16];                     /* Name (for debugging purposes). */
+    int priority;                      /* Default item priority. */
+    struct lock lock;                  /* Protects all members below. */
+    struct condition work_ready;       /* Signaled when work is queued. */
+    struct condition idle;             /* Broadcast when PENDING hits 0. */
+    struct list queues[PRI_MAX + 1];   /* Queued items, by priority. */
+    uint64_t nonempty;                 /* Bit P set if queues[P] nonempty. */
+    size_t pending;                    /* Number of items queued or running. */
+    struct list free_items;            /* Recycled items. */
+    int worker_cnt;                    /* Number of worker threads. */
+    bool stopping;                     /* Set by workqueue_destroy(). */
+    struct semaphore workers_done;     /* Upped by each exiting worker. */
+};
+
+bool workqueue_init (struct workqueue *, const char *name,
+                     int worker_cnt, int priority);
+bool workqueue_submit (struct workqueue *, work_func *, void *aux);
+bool workqueue_submit_pri (struct workqueue *, work_func *, void *aux,
+                           int priority);
+void workqueue_flush (struct workqueue *);
+void workqueue_destroy (struct workqueue *);
+
+#endif /* threads/workqueue.h */
@@ -43,7 +43,8 @@ exception_init (void)
      caused indirectly, e.g. #DE can be caused by dividing by
      0.  */
     intr_register_int (0, 0, INTR_ON, kill, "#DE Divide Error");
-    intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
+    if (!thread_stack_check) /* Otherwise thread.c watches for overflow. */
+        intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
     intr_register_int (6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
     intr_register_int (7, 0, INTR_ON, kill,
                        "#NM Device Not Available Exception");
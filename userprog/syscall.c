@@ -1,8 +1,12 @@
 #include "userprog/syscall.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <syscall-nr.h>
+#include "threads/futex.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
 
 static void syscall_handler (struct intr_frame *);
 
@@ -12,9 +16,70 @@ syscall_init (void)
     intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
 }
 
+/* Returns true if the SIZE bytes at user address UADDR are all
+   mapped in the running process.  SIZE must not exceed PGSIZE. */
+static bool
+user_mapped (const void *uaddr, size_t size)
+{
+    const uint8_t *first = uaddr;
+    const uint8_t *last = first + size - 1;
+    uint32_t *pd = thread_current ()->pagedir;
+
+    return (last >= first && is_user_vaddr (last)
+            && pagedir_get_page (pd, first) != NULL
+            && pagedir_get_page (pd, last) != NULL);
+}
+
+/* Returns the address of a futex word passed as a system call
+   argument, or kills the process if it is not an aligned, mapped
+   user address.  Alignment keeps the word within one page and
+   lets user code update it with a single atomic instruction. */
+static const int *
+futex_arg (uint32_t uaddr)
+{
+    const int *addr = (const int *) uaddr;
+
+    if (uaddr % sizeof *addr != 0 || !user_mapped (addr, sizeof *addr))
+        thread_exit ();
+    return addr;
+}
+
+/* Returns the CNT arguments that follow the system call number
+   on the user stack at ESP, or kills the process if they are not
+   all mapped. */
+static const uint32_t *
+syscall_args (const void *esp, int cnt)
+{
+    const uint32_t *args = (const uint32_t *) esp + 1;
+
+    if (!user_mapped (args, cnt * sizeof *args))
+        thread_exit ();
+    return args;
+}
+
 static void
-syscall_handler (struct intr_frame *f UNUSED)
+syscall_handler (struct intr_frame *f)
 {
-    printf ("system call!\n");
-    thread_exit ();
+    const uint32_t *nr = f->esp;
+    const uint32_t *args;
+
+    if (!user_mapped (nr, sizeof *nr))
+        thread_exit ();
+
+    switch (*nr)
+        {
+        case SYS_FUTEX_WAIT:
+            args = syscall_args (f->esp, 2);
+            f->eax = futex_wait (futex_arg (args[0]), args[1], -1);
+            break;
+
+        case SYS_FUTEX_WAKE:
+            args = syscall_args (f->esp, 2);
+            f->eax = futex_wake (futex_arg (args[0]), args[1]);
+            break;
+
+        default:
+            printf ("system call!\n");
+            thread_exit ();
+        }
 }